@@ -0,0 +1,115 @@
+/* core/dynamic_bitset.h: Sets of small integers, one bit each.
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#ifndef STELLARIS_STAT_VIEWER_DYNAMIC_BITSET_H
+#define STELLARIS_STAT_VIEWER_DYNAMIC_BITSET_H
+
+#include <QtCore/QVector>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QtGlobal>
+
+namespace Galaxy {
+	/** A set of the integers from 0 to size() - 1, stored as one bit per integer.
+	 *
+	 * Set operations work on 64 bits at a time, so combining or counting sets of a few hundred
+	 * technologies takes a handful of instructions. Binary operations require both operands to
+	 * have the same size.
+	 */
+	class DynamicBitset {
+	public:
+		DynamicBitset() = default;
+		explicit DynamicBitset(int size) : words((size + 63) / 64, 0), bits(size) {}
+
+		int size() const { return bits; }
+		/** Grow or shrink the set to `size', keeping all elements below it. */
+		void resize(int size) {
+			words.resize((size + 63) / 64);
+			if (size < bits && size % 64) words.last() &= ~quint64(0) >> (64 - size % 64);
+			bits = size;
+		}
+
+		bool test(int i) const { return words[i / 64] & bit(i); }
+		void set(int i) { words[i / 64] |= bit(i); }
+		void reset(int i) { words[i / 64] &= ~bit(i); }
+
+		int count() const {
+			int result = 0;
+			for (quint64 word : words) result += qPopulationCount(word);
+			return result;
+		}
+		bool any() const {
+			for (quint64 word : words) if (word) return true;
+			return false;
+		}
+		/** Number of elements in both this set and `other', without creating the intersection. */
+		int countCommon(const DynamicBitset &other) const {
+			int result = 0;
+			for (int i = 0; i < words.size(); i++) result += qPopulationCount(words[i] & other.words[i]);
+			return result;
+		}
+		bool isSubsetOf(const DynamicBitset &other) const {
+			for (int i = 0; i < words.size(); i++) if (words[i] & ~other.words[i]) return false;
+			return true;
+		}
+		bool intersects(const DynamicBitset &other) const {
+			for (int i = 0; i < words.size(); i++) if (words[i] & other.words[i]) return true;
+			return false;
+		}
+
+		/** The smallest element that is at least `from', or -1 if there is none. To visit every element:
+		 *  `for (int i = set.next(0); i >= 0; i = set.next(i + 1))' */
+		int next(int from) const {
+			if (from >= bits) return -1;
+			int index = from / 64;
+			quint64 word = words[index] & (~quint64(0) << (from % 64));
+			while (!word) {
+				if (++index == words.size()) return -1;
+				word = words[index];
+			}
+			return index * 64 + qCountTrailingZeroBits(word);
+		}
+
+		DynamicBitset &operator|=(const DynamicBitset &other) {
+			for (int i = 0; i < words.size(); i++) words[i] |= other.words[i];
+			return *this;
+		}
+		DynamicBitset &operator&=(const DynamicBitset &other) {
+			for (int i = 0; i < words.size(); i++) words[i] &= other.words[i];
+			return *this;
+		}
+		/** Remove all elements of `other' from this set. */
+		DynamicBitset &operator-=(const DynamicBitset &other) {
+			for (int i = 0; i < words.size(); i++) words[i] &= ~other.words[i];
+			return *this;
+		}
+		friend DynamicBitset operator|(DynamicBitset a, const DynamicBitset &b) { return a |= b; }
+		friend DynamicBitset operator&(DynamicBitset a, const DynamicBitset &b) { return a &= b; }
+		friend DynamicBitset operator-(DynamicBitset a, const DynamicBitset &b) { return a -= b; }
+		bool operator==(const DynamicBitset &other) const { return bits == other.bits && words == other.words; }
+		bool operator!=(const DynamicBitset &other) const { return !(*this == other); }
+
+	private:
+		static quint64 bit(int i) { return quint64(1) << (i % 64); }
+
+		QVector<quint64> words;  // bits beyond size() are always zero
+		int bits = 0;
+	};
+}
+
+#endif //STELLARIS_STAT_VIEWER_DYNAMIC_BITSET_H
@@ -17,17 +17,36 @@
 
 #include "empire.h"
 
-#include <QtCore/QRegularExpression>
-
 #include "model_private_macros.h"
 #include "galaxy_state.h"
 #include "gametranslator.h"
+#include "keyword_table.h"
 #include "parser.h"
 
 using Parsing::AstNode;
 
 namespace Galaxy {
-	Empire::Empire(State *parent) : QObject(parent), ownedSystems(0) {}
+	static constexpr Parsing::KeywordTable<Resource, static_cast<size_t>(Resource::COUNT)> resourceKeys({{
+		{ "energy", Resource::Energy },
+		{ "minerals", Resource::Minerals },
+		{ "food", Resource::Food },
+		{ "influence", Resource::Influence },
+		{ "unity", Resource::Unity },
+		{ "alloys", Resource::Alloys },
+		{ "consumer_goods", Resource::ConsumerGoods },
+		{ "volatile_motes", Resource::VolatileMotes },
+		{ "rare_crystals", Resource::RareCrystals },
+		{ "exotic_gases", Resource::ExoticGases },
+		{ "sr_zro", Resource::Zro },
+		{ "sr_dark_matter", Resource::DarkMatter },
+		{ "sr_living_metal", Resource::LivingMetal },
+		{ "nanites", Resource::Nanites },
+		{ "physics_research", Resource::PhysicsResearch },
+		{ "society_research", Resource::SocietyResearch },
+		{ "engineering_research", Resource::EngineeringResearch }
+	}});
+
+	Empire::Empire(State *parent) : QObject(parent), ordinal(-1), incomes() {}
 
 	qint64 Empire::getIndex() const {
 		return index;
@@ -49,21 +68,29 @@ namespace Galaxy {
 		return this->techPower;
 	}
 
-	quint32 Empire::getOwnedSystemsCount() const {
-		return ownedSystems;
+	int Empire::getOrdinal() const {
+		return ordinal;
+	}
+
+	double Empire::getIncome(Resource resource) const {
+		return incomes[static_cast<size_t>(resource)];
 	}
 
-	const QMap<QString, double> &Empire::getIncomes() const {
-		return incomes;
+	const QMap<QString, double> &Empire::getOtherIncomes() const {
+		return otherIncomes;
 	}
 
-	const QStringList &Empire::getTechnologies() const {
+	const DynamicBitset &Empire::getTechnologies() const {
 		return technologies;
 	}
 
+	bool Empire::hasTechnology(int id) const {
+		return id >= 0 && id < technologies.size() && technologies.test(id);
+	}
+
 	Empire *Empire::createFromAst(const AstNode *tree, State *parent, const GameTranslator *translator) {
 		Empire *state = new Empire(parent);
-		state->index = static_cast<qint64>(QString(tree->myName).toLongLong());
+		state->index = tree->intKey;
 		AstNode *nameNode = tree->findChildWithName("name");
 		CHECK_PTR(nameNode);
 		if (nameNode->type == Parsing::NT_COMPOUND) {
@@ -79,21 +106,12 @@ namespace Galaxy {
 				if (translator) state->name = translator->getTranslationOf(keyNode->val.Str);
 				else state->name = keyNode->val.Str;
 			} else {  // we need to go deeper.
-				QMap<QString, QString> vars;
-				// load all the variables into a convenient format
+				NameTemplate::Variables variables;
 				ITERATE_CHILDREN(varsNode, var) {
-					vars[var->val.firstChild->val.Str] = var->val.lastChild->val.firstChild->val.Str;
+					variables.append({ var->val.firstChild->val.Str,
+							translator->getTranslationOf(QString::fromUtf8(var->val.lastChild->val.firstChild->val.Str)) });
 				}
-				// get the format string
-				QString format = translator->getTranslationOf(keyNode->val.Str);
-				QRegularExpression angles("<(.*?)>");
-				QRegularExpression squares("\\[(.*?)\\]");
-				QRegularExpressionMatch amatch;
-				while ((amatch = angles.match(format)).hasMatch())
-					format.replace(amatch.captured(0), translator->getTranslationOf(vars[amatch.captured(1)]));
-				auto smatch = squares.match(format);
-				if (smatch.hasMatch())
-					format.replace(smatch.captured(0), translator->getTranslationOf(vars[smatch.captured(1)]));
+				QString format = translator->getNameTemplate(keyNode->val.Str).apply(variables);
 				state->name = translator->getTranslationOf(format);
 			}
 		} else if (nameNode->type == Parsing::NT_STRING) {
@@ -110,7 +128,10 @@ namespace Galaxy {
 		}
 		ITERATE_CHILDREN(techNode, aTech) {
 			if (qstrcmp(aTech->myName, "technology") == 0 && aTech->type == Parsing::NT_STRING) {
-				state->technologies.append(QString(aTech->val.Str));
+				const int id = parent->internTechnology(aTech->val.Str);
+				// The set is only brought to its final size, the number of all technologies, by StateFactory.
+				if (id >= state->technologies.size()) state->technologies.resize(id + 1);
+				state->technologies.set(id);
 			}
 		}
 
@@ -140,7 +161,12 @@ namespace Galaxy {
 						if (anItem->type == Parsing::NT_COMPOUND) {
 							ITERATE_CHILDREN(anItem, aResource) {
 								// For some reason, game version 2.6 stopped writing integers as e.g. '17.0'
-								state->incomes[QString(aResource->myName)] += aResource->type == Parsing::NT_DOUBLE ? aResource->val.Double : (double) aResource->val.Int;
+								double amount = aResource->type == Parsing::NT_DOUBLE ? aResource->val.Double : (double) aResource->val.Int;
+								if (auto known = resourceKeys.find(aResource->myName)) {
+									state->incomes[static_cast<size_t>(*known)] += amount;
+								} else {
+									state->otherIncomes[QString(aResource->myName)] += amount;
+								}
 							}
 						}
 					}
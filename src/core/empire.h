@@ -20,18 +20,43 @@
 #ifndef STELLARIS_STAT_VIEWER_EMPIRE_H
 #define STELLARIS_STAT_VIEWER_EMPIRE_H
 
+#include <array>
+
 #include <QtCore/QObject>
 #include <QtCore/QMap>
 #include <QtCore/QStringList>
 
+#include "dynamic_bitset.h"
+
 class GameTranslator;
 
 namespace Parsing { struct AstNode; }
 
 namespace Galaxy {
-	class Ship;
 	class State;
 
+	/** The resources that the views and exporters know about, i.e. have a fixed place for. */
+	enum class Resource {
+		Energy,
+		Minerals,
+		Food,
+		Influence,
+		Unity,
+		Alloys,
+		ConsumerGoods,
+		VolatileMotes,
+		RareCrystals,
+		ExoticGases,
+		Zro,
+		DarkMatter,
+		LivingMetal,
+		Nanites,
+		PhysicsResearch,
+		SocietyResearch,
+		EngineeringResearch,
+		COUNT
+	};
+
 	class Empire : public QObject {
 		Q_OBJECT
 	public:
@@ -41,9 +66,15 @@ namespace Galaxy {
 		double getMilitaryPower() const;
 		double getEconomyPower() const;
 		double getTechPower() const;
-		quint32 getOwnedSystemsCount() const;
-		const QMap<QString, double> &getIncomes() const;
-		const QStringList &getTechnologies() const;
+		/** Dense index of this empire within its state, in order of getIndex(). */
+		int getOrdinal() const;
+		/** Last month's net income of the given resource. */
+		double getIncome(Resource resource) const;
+		/** Net incomes of all resources that have no Resource value, by their name in the save. */
+		const QMap<QString, double> &getOtherIncomes() const;
+		/** The researched technologies, by the ids of State::getTechnologyNames(). */
+		const DynamicBitset &getTechnologies() const;
+		bool hasTechnology(int id) const;
 		static Empire *createFromAst(const Parsing::AstNode *tree, State *parent, const GameTranslator *translator);
 	private:
 		qint64 index;
@@ -51,10 +82,11 @@ namespace Galaxy {
 		double militaryPower;
 		double economyPower;
 		double techPower;
-		quint32 ownedSystems;
-		QMap<QString, double> incomes;
-		QStringList technologies;
-		friend class Ship;
+		int ordinal;
+		std::array<double, static_cast<size_t>(Resource::COUNT)> incomes;
+		QMap<QString, double> otherIncomes;
+		DynamicBitset technologies;
+		friend class StateFactory;
 	};
 }
 
@@ -20,6 +20,8 @@
 
 #include <QtCore/QTextStream>
 
+#include "tracing.h"
+
 extern "C" {
 #include "puff/puff.h"
 }
@@ -51,6 +53,7 @@ inline T endianSwap(T in) {
  * 6: input file is too short
  */
 int extractGamestate(QFile &f, unsigned char **dest, unsigned long *destsize) {
+	SSV_TRACE_SCOPE("extractGamestate");
 	QByteArray arr(f.readAll());
 	if (arr.size() < 39) return 6;
 	const char *data = arr.data();
@@ -71,6 +74,29 @@ int extractGamestate(QFile &f, unsigned char **dest, unsigned long *destsize) {
 	return puff(puffdest, destsize, compr, &inputSize);
 }
 
+bool hasCompleteZipDirectory(QFile &f) {
+	// The EOCD record is 22 bytes plus a comment of up to 65535 bytes, and it is the last thing
+	// written to a ZIP file, so it can only be found once the writer is done.
+	const qint64 eocdSize = 22;
+	qint64 fileSize = f.size();
+	if (fileSize < eocdSize) return false;
+	qint64 tailSize = qMin(fileSize, eocdSize + 0xffff);
+	if (!f.seek(fileSize - tailSize)) return false;
+	QByteArray tail(f.read(tailSize));
+	if (tail.size() != tailSize) return false;
+	const char *data = tail.constData();
+	for (qint64 i = tailSize - eocdSize; i >= 0; i--) {
+		if (LEtoSystem(*reinterpret_cast<const quint32 *>(&data[i])) != 0x06054b50) continue;
+		quint32 directorySize = LEtoSystem(*reinterpret_cast<const quint32 *>(&data[i+12]));
+		quint32 directoryOffset = LEtoSystem(*reinterpret_cast<const quint32 *>(&data[i+16]));
+		quint16 commentLength = LEtoSystem(*reinterpret_cast<const quint16 *>(&data[i+20]));
+		qint64 eocdOffset = fileSize - tailSize + i;
+		// Make sure this is not just a stray signature inside compressed data.
+		if (i + eocdSize + commentLength == tailSize && (qint64) directoryOffset + directorySize == eocdOffset) return true;
+	}
+	return false;
+}
+
 QString getInflateErrmsg(int result) {
 	switch (result) {
 		case 6:
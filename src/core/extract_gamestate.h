@@ -23,6 +23,10 @@
 
 int extractGamestate(QFile &f, unsigned char **dest, unsigned long *destsize);
 
+/** Cheaply check whether a ZIP file has been written in full, by looking for a consistent
+ *  end-of-central-directory record at its end. Does not inflate anything. */
+bool hasCompleteZipDirectory(QFile &f);
+
 QString getInflateErrmsg(int result);
 
 #endif //STELLARIS_STAT_VIEWER_EXTRACT_GAMESTATE_H
@@ -50,7 +50,7 @@ namespace Galaxy {
 		if (tree->type == Parsing::NT_STRING && qstrcmp(tree->val.Str, "none") == 0) return nullptr;
 
 		Fleet *state = new Fleet(parent);
-		state->index = static_cast<qint64>(QString(tree->myName).toLongLong());
+		state->index = tree->intKey;
 
 		AstNode *nameNode = tree->findChildWithName("name");
 		CHECK_PTR(nameNode);
@@ -17,12 +17,26 @@
 
 #include "galaxy_model.h"
 
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QThread>
+#include <QtCore/QtAlgorithms>
+
 #include "model_private_macros.h"
 #include "technology.h"
 #include "parser.h"
+#include "tracing.h"
 
 using Parsing::AstNode;
 
+// Bump whenever the cache layout or Technology::serialize() changes.
+static const quint32 techCacheMagic = 0x53535643;  // "SSVC"
+static const quint32 techCacheVersion = 1;
+
 namespace Galaxy {
 	Model::Model(QObject *parent) : QObject(parent) {}
 
@@ -41,13 +55,133 @@ namespace Galaxy {
 			if (newTech) techs[newTech->getName()] = newTech;
 		}
 	}
+
+	void Model::adoptTechnologies(const QVector<Technology *> &newTechs) {
+		for (Technology *tech : newTechs) {
+			tech->setParent(this);
+			techs[tech->getName()] = tech;
+		}
+	}
+
+	TechCache::TechCache(const QString &cacheFile) : cacheFile(cacheFile) {
+		QFile f(cacheFile);
+		if (!f.open(QIODevice::ReadOnly)) return;
+		QDataStream in(&f);
+		in.setVersion(QDataStream::Qt_6_0);
+		quint32 magic, version, count;
+		in >> magic >> version;
+		if (magic != techCacheMagic || version != techCacheVersion) return;
+		in >> count;
+		for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+			QString path;
+			Entry entry;
+			in >> path >> entry.size >> entry.modified >> entry.technologies;
+			entries.insert(path, entry);
+		}
+		if (in.status() != QDataStream::Ok) entries.clear();
+	}
+
+	QString TechCache::defaultFile() {
+		const QString cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+		return cacheDir.isEmpty() ? QString() : QDir(cacheDir).absoluteFilePath("technologies.bin");
+	}
+
+	bool TechCache::lookup(const QFileInfo &in, QThread *target, QVector<Technology *> &out) const {
+		auto it = entries.constFind(in.absoluteFilePath());
+		if (it == entries.cend() || it->size != in.size() || it->modified != in.lastModified()) return false;
+		// Technologies are kept serialized so that each worker only pays for the files it asks for.
+		QDataStream stream(it->technologies);
+		stream.setVersion(QDataStream::Qt_6_0);
+		quint32 count;
+		stream >> count;
+		QVector<Technology *> result;
+		for (quint32 i = 0; i < count; i++) {
+			Technology *tech = Technology::deserialize(stream, nullptr);
+			if (!tech) {
+				qDeleteAll(result);
+				return false;
+			}
+			tech->moveToThread(target);
+			result.append(tech);
+		}
+		out = result;
+		return true;
+	}
+
+	void TechCache::store(const QFileInfo &in, const QVector<Technology *> &fileTechs) {
+		const QString path(in.absoluteFilePath());
+		stored.insert(path);
+		auto it = entries.constFind(path);
+		if (it != entries.cend() && it->size == in.size() && it->modified == in.lastModified()) return;
+
+		Entry entry { in.size(), in.lastModified(), QByteArray() };
+		QDataStream stream(&entry.technologies, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_6_0);
+		stream << quint32(fileTechs.size());
+		for (const Technology *tech : fileTechs) tech->serialize(stream);
+		entries.insert(path, entry);
+		changed = true;
+	}
+
+	bool TechCache::save() {
+		for (auto it = entries.begin(); it != entries.end();) {
+			if (stored.contains(it.key())) {
+				it++;
+			} else {
+				it = entries.erase(it);
+				changed = true;
+			}
+		}
+		if (!changed || cacheFile.isEmpty()) return true;
+
+		QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+		QSaveFile f(cacheFile);
+		if (!f.open(QIODevice::WriteOnly)) return false;
+		QDataStream out(&f);
+		out.setVersion(QDataStream::Qt_6_0);
+		out << techCacheMagic << techCacheVersion << quint32(entries.size());
+		for (auto it = entries.cbegin(); it != entries.cend(); it++) {
+			out << it.key() << it->size << it->modified << it->technologies;
+		}
+		if (out.status() != QDataStream::Ok || !f.commit()) return false;
+		changed = false;
+		return true;
+	}
 }
 
-void readAnotherTechFile(const QFileInfo &in, Galaxy::Model &model) {
+QVector<Galaxy::Technology *> readTechFile(const QFileInfo &in, QThread *target) {
+	SSV_TRACE_SCOPE("readTechFile");
+	QVector<Galaxy::Technology *> result;
 	QFile f(in.absoluteFilePath());
-	f.open(QIODevice::ReadOnly);
+	if (!f.open(QIODevice::ReadOnly)) return result;
 	Parsing::MemBuf buf(f);
 	Parsing::Parser parser(buf, Parsing::FileType::GameFile);
 	Parsing::AstNode *tree = parser.parse();
-	if (tree) model.addTechnologies(tree);
-}
\ No newline at end of file
+	if (!tree || tree->type != Parsing::NT_COMPOUND) return result;
+	ITERATE_CHILDREN(tree, aTech) {
+		Galaxy::Technology *newTech = Galaxy::Technology::createFromAst(aTech, nullptr);
+		if (!newTech) continue;
+		newTech->moveToThread(target);
+		result.append(newTech);
+	}
+	return result;
+}
+
+QFuture<QVector<Galaxy::Technology *>> readTechFiles(const QFileInfoList &files, QThread *target,
+		const Galaxy::TechCache *cache) {
+	return QtConcurrent::mapped(files, [target, cache](const QFileInfo &file) {
+		QVector<Galaxy::Technology *> fileTechs;
+		if (cache->lookup(file, target, fileTechs)) return fileTechs;
+		return readTechFile(file, target);
+	});
+}
+
+void adoptTechFiles(const QFileInfoList &files, const QList<QVector<Galaxy::Technology *>> &results,
+		Galaxy::Model *model, Galaxy::TechCache *cache) {
+	// Results come in file name order, so later files override earlier ones deterministically.
+	for (int i = 0; i < results.size(); i++) {
+		cache->store(files[i], results[i]);
+		model->adoptTechnologies(results[i]);
+	}
+	cache->save();
+}
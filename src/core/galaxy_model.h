@@ -22,12 +22,19 @@
 #ifndef STELLARIS_STAT_VIEWER_GALAXY_MODEL_H
 #define STELLARIS_STAT_VIEWER_GALAXY_MODEL_H
 
+#include <QtCore/QByteArray>
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+#include <QtCore/QFuture>
+#include <QtCore/QHash>
 #include <QtCore/QMap>
 #include <QtCore/QObject>
+#include <QtCore/QSet>
 #include <QtCore/QString>
+#include <QtCore/QVector>
 
 namespace Parsing { struct AstNode; }
-class QFileInfo;
+class QThread;
 
 namespace Galaxy {
 	class Technology;
@@ -39,11 +46,58 @@ namespace Galaxy {
 		const QMap<QString, Technology *> &getTechnologies() const;
 		const Technology *getTechnology(const QString &name) const;
 		void addTechnologies(const Parsing::AstNode *tree);
+		/** Take ownership of technologies created elsewhere, which must already live in this model's thread.
+		 *  Technologies replace any earlier ones of the same name. */
+		void adoptTechnologies(const QVector<Technology *> &newTechs);
 	private:
 		QMap<QString, Technology *> techs;
 	};
+
+	/** Technologies read from the game's files in earlier runs, remembered per file.
+	 *
+	 * An entry is only used while its file still has the size and modification time it had when
+	 * the entry was stored, so a patch invalidates exactly the files it touched.
+	 */
+	class TechCache {
+	public:
+		/** Load the cache from `cacheFile'. A missing, outdated or damaged cache file just leaves the cache empty. */
+		explicit TechCache(const QString &cacheFile = defaultFile());
+		/** technologies.bin in the user's cache location, or an empty string if there is none. */
+		static QString defaultFile();
+
+		/** Create the technologies remembered for `in', moved to `target', in `out'. Returns false if
+		 *  there is no valid entry for the file. Safe to call from several threads at once, but not
+		 *  while store() is running. */
+		bool lookup(const QFileInfo &in, QThread *target, QVector<Technology *> &out) const;
+		/** Remember `fileTechs' as the contents of `in'. Call this for every file that is still part
+		 *  of the game, including those found by lookup(); current entries are left as they are. */
+		void store(const QFileInfo &in, const QVector<Technology *> &fileTechs);
+		/** Write the cache back, dropping the entries of files that store() wasn't called for since
+		 *  the cache was loaded. Does nothing if nothing changed. */
+		bool save();
+	private:
+		struct Entry {
+			qint64 size;
+			QDateTime modified;
+			QByteArray technologies;
+		};
+		QString cacheFile;
+		QHash<QString, Entry> entries;
+		QSet<QString> stored;
+		bool changed = false;
+	};
 }
 
-void readAnotherTechFile(const QFileInfo &in, Galaxy::Model &model);
+/** Parse one file of technology definitions. This is safe to run on any thread; the technologies
+ *  returned have no parent and are moved to `target', ready to be adopted by a Model living there. */
+QVector<Galaxy::Technology *> readTechFile(const QFileInfo &in, QThread *target);
+/** Start reading `files' on the global thread pool, from `cache' where possible, with technologies moved to
+ *  `target'. The future has one result per file, in the order of `files'; once it has finished, hand them
+ *  to adoptTechFiles(). `cache' must not be modified or destroyed before then. */
+QFuture<QVector<Galaxy::Technology *>> readTechFiles(const QFileInfoList &files, QThread *target,
+		const Galaxy::TechCache *cache);
+/** Add the results of readTechFiles() to `model', later files overriding earlier ones, and save them to `cache'. */
+void adoptTechFiles(const QFileInfoList &files, const QList<QVector<Galaxy::Technology *>> &results,
+		Galaxy::Model *model, Galaxy::TechCache *cache);
 
 #endif //STELLARIS_STAT_VIEWER_GALAXY_MODEL_H
\ No newline at end of file
@@ -17,13 +17,18 @@
 
 #include "galaxy_state.h"
 
+#include <cstring>
+#include <utility>
+
 #include "empire.h"
 #include "fleet.h"
 #include "gametranslator.h"
+#include "instrumentation.h"
 #include "model_private_macros.h"
 #include "ship.h"
 #include "ship_design.h"
 #include "parser.h"
+#include "tracing.h"
 
 using Parsing::AstNode;
 
@@ -54,18 +59,65 @@ namespace Galaxy {
 		return shipDesigns;
 	}
 
+	const EmpireAggregates &State::getAggregates(const Empire *empire) const {
+		return aggregates[empire->getOrdinal()];
+	}
+
+	const QStringList &State::getTechnologyNames() const {
+		return technologyNames;
+	}
+
+	int State::getTechnologyId(const QString &name) const {
+		return technologyIds.value(name, -1);
+	}
+
+	const QVector<int> &State::getTechnologyHolderCounts() const {
+		return technologyHolders;
+	}
+
+	// The parser pools its strings, so equal names are the same pointer, and a name only has to be
+	// converted to a QString the first time it is seen.
+	int State::internTechnology(const char *name) {
+		auto it = pooledTechnologyIds.constFind(name);
+		if (it != pooledTechnologyIds.cend()) return it.value();
+		const int id = technologyNames.size();
+		technologyNames.append(QString::fromUtf8(name));
+		technologyIds.insert(technologyNames.last(), id);
+		pooledTechnologyIds.insert(name, id);
+		return id;
+	}
+
+	// Like AstNode::findChildWithName(), but leaves the section unparsed if it is lazy.
+	static AstNode *findSection(const AstNode *tree, const char *name) {
+		ITERATE_CHILDREN(tree, child) {
+			if (strcmp(child->myName, name) == 0) return child;
+		}
+		return nullptr;
+	}
+
 	State *StateFactory::createFromAst(const Parsing::AstNode *tree, const GameTranslator* translator, QObject *parent) {
 		// figure out how many objects we need to create so we can display a proper progress bar
 		int done = 0;
 		int toDo = 1;
-		AstNode *ast_countries = tree->findChildWithName("country");
-		AstNode *ast_fleets = tree->findChildWithName("fleet");
-		AstNode *ast_shipDesigns = tree->findChildWithName("ship_design");
-		AstNode *ast_ships = tree->findChildWithName("ships");
-		toDo += ast_countries->countChildren();
-		toDo += ast_fleets->countChildren();
-		toDo += ast_shipDesigns->countChildren();
-		toDo += ast_ships->countChildren();
+		AstNode *ast_countries = findSection(tree, "country");
+		AstNode *ast_fleets = findSection(tree, "fleet");
+		AstNode *ast_shipDesigns = findSection(tree, "ship_design");
+		AstNode *ast_ships = findSection(tree, "ships");
+		// Lazy sections are only parsed, one after the other, once they're needed, so that the ones before can
+		// be released first (see sectionFinished()). They are counted then, too. Parsing is timed on its own,
+		// so it happens outside of the phases below.
+		auto count = [&toDo](AstNode *section) {
+			if (section && section->type != Parsing::NT_LAZY) toDo += section->countChildren();
+		};
+		auto expand = [&toDo](AstNode *section) {
+			if (!section || section->type != Parsing::NT_LAZY) return;
+			section->expand();
+			toDo += section->countChildren();
+		};
+		count(ast_countries);
+		count(ast_fleets);
+		count(ast_shipDesigns);
+		count(ast_ships);
 
 		emit progress(this, done, toDo);
 		if (shouldCancel) return nullptr;
@@ -76,50 +128,133 @@ namespace Galaxy {
 		state->date = QString(ast_date->val.Str);
 		emit progress(this, ++done, toDo);
 
-		CHECK_COMPOUND(ast_countries);
-		ITERATE_CHILDREN(ast_countries, aCountry) {
-			Empire *created = Empire::createFromAst(aCountry, state, translator);
-			if (created) {
-				// sometimes, the save file contains nonsensical lines such as "16777248=none"
-				state->empires.insert(created->getIndex(), created);
+		expand(ast_countries);
+		{
+			ScopedTimer timer(statistics, LoadStatistics::BuildEmpires);
+			SSV_TRACE_SCOPE("StateFactory: empires");
+			CHECK_COMPOUND(ast_countries);
+			ITERATE_CHILDREN(ast_countries, aCountry) {
+				Empire *created = Empire::createFromAst(aCountry, state, translator);
+				if (created) {
+					// sometimes, the save file contains nonsensical lines such as "16777248=none"
+					state->empires.insert(created->getIndex(), created);
+				}
+				emit progress(this, ++done, toDo);
+				if (shouldCancel) { delete state; return nullptr; }
 			}
-			emit progress(this, ++done, toDo);
-			if (shouldCancel) { delete state; return nullptr; }
+			emit sectionFinished(ast_countries);
 		}
 
-		CHECK_COMPOUND(ast_fleets);
-		ITERATE_CHILDREN(ast_fleets, aFleet) {
-			Fleet *created = Fleet::createFromAst(aFleet, state);
-			if (created) {
-				state->fleets.insert(created->getIndex(), created);
+		expand(ast_fleets);
+		{
+			ScopedTimer timer(statistics, LoadStatistics::BuildFleets);
+			SSV_TRACE_SCOPE("StateFactory: fleets");
+			CHECK_COMPOUND(ast_fleets);
+			ITERATE_CHILDREN(ast_fleets, aFleet) {
+				Fleet *created = Fleet::createFromAst(aFleet, state);
+				if (created) {
+					state->fleets.insert(created->getIndex(), created);
+				}
+				emit progress(this, ++done, toDo);
+				if (shouldCancel) { delete state; return nullptr; }
 			}
-			emit progress(this, ++done, toDo);
-			if (shouldCancel) { delete state; return nullptr; }
+			emit sectionFinished(ast_fleets);
 		}
 
-		CHECK_COMPOUND(ast_shipDesigns);
-		ITERATE_CHILDREN(ast_shipDesigns, aDesign) {
-			ShipDesign *created = ShipDesign::createFromAst(aDesign, state);
-			if (created) {
-				state->shipDesigns.insert(created->getIndex(), created);
+		expand(ast_shipDesigns);
+		{
+			ScopedTimer timer(statistics, LoadStatistics::BuildShipDesigns);
+			SSV_TRACE_SCOPE("StateFactory: ship designs");
+			CHECK_COMPOUND(ast_shipDesigns);
+			ITERATE_CHILDREN(ast_shipDesigns, aDesign) {
+				ShipDesign *created = ShipDesign::createFromAst(aDesign, state);
+				if (created) {
+					state->shipDesigns.insert(created->getIndex(), created);
+				}
+				emit progress(this, ++done, toDo);
+				if (shouldCancel) { delete state; return nullptr; }
 			}
-			emit progress(this, ++done, toDo);
-			if (shouldCancel) { delete state; return nullptr; }
+			emit sectionFinished(ast_shipDesigns);
 		}
 
-		CHECK_COMPOUND(ast_ships);
-		ITERATE_CHILDREN(ast_ships, aShip) {
-			Ship *created = Ship::createFromAst(aShip, state);
-			if (created) {
-				state->ships.insert(created->getIndex(), created);
+		expand(ast_ships);
+		{
+			ScopedTimer timer(statistics, LoadStatistics::BuildShips);
+			SSV_TRACE_SCOPE("StateFactory: ships");
+			CHECK_COMPOUND(ast_ships);
+			ITERATE_CHILDREN(ast_ships, aShip) {
+				Ship *created = Ship::createFromAst(aShip, state);
+				if (created) {
+					state->ships.insert(created->getIndex(), created);
+				}
+				emit progress(this, ++done, toDo);
+				if (shouldCancel) { delete state; return nullptr; }
 			}
-			emit progress(this, ++done, toDo);
-			if (shouldCancel) { delete state; return nullptr; }
+			emit sectionFinished(ast_ships);
+		}
+
+		{
+			ScopedTimer timer(statistics, LoadStatistics::Aggregates);
+			SSV_TRACE_SCOPE("StateFactory: aggregates");
+			computeAggregates(state);
 		}
 		return state;
 	}
 
+	// Walk all fleets and ships once to fill the per-empire aggregates table, so views
+	// and exporters don't have to repeat that work.
+	void StateFactory::computeAggregates(State *state) {
+		int ordinal = 0;
+		for (Empire *empire : std::as_const(state->empires)) {
+			empire->ordinal = ordinal++;
+		}
+		state->aggregates.fill(EmpireAggregates(), state->empires.size());
+
+		// Technologies were interned as the empires were read, so only now are all of them known.
+		// Technologies researched by more than one empire end up in `shared', the rest is unique.
+		const int technologyCount = state->technologyNames.size();
+		state->pooledTechnologyIds.clear();  // the pointers belong to the parse tree, which the state outlives
+		DynamicBitset seen(technologyCount), shared(technologyCount);
+		state->technologyHolders.fill(0, technologyCount);
+		for (Empire *empire : std::as_const(state->empires)) {
+			empire->technologies.resize(technologyCount);
+			shared |= seen & empire->technologies;
+			seen |= empire->technologies;
+			const DynamicBitset &techs = empire->technologies;
+			for (int id = techs.next(0); id >= 0; id = techs.next(id + 1)) state->technologyHolders[id]++;
+		}
+		for (const Empire *empire : std::as_const(state->empires)) {
+			EmpireAggregates &totals = state->aggregates[empire->ordinal];
+			totals.technologyCount = empire->technologies.count();
+			totals.uniqueTechnologies = (empire->technologies - shared).count();
+		}
+
+		for (const Fleet *fleet : std::as_const(state->fleets)) {
+			EmpireAggregates &totals = state->aggregates[fleet->getOwner()->ordinal];
+			totals.fleetCount += 1;
+			totals.fleetPowerWithStations += fleet->getMilitaryPower();
+			if (!fleet->getIsStation()) totals.fleetPower += fleet->getMilitaryPower();
+		}
+
+		for (const Ship *ship : std::as_const(state->ships)) {
+			EmpireAggregates &totals = state->aggregates[ship->getFleet()->getOwner()->ordinal];
+			ShipSize size = ship->getDesign()->getSize();
+			totals.shipsBySize[static_cast<size_t>(size)] += 1;
+			if (size <= ShipSize::StarbaseCitadel) {  // this is a starbase of some description, implying system ownership
+				totals.ownedSystems += 1;
+			}
+		}
+	}
+
 	void StateFactory::cancel() {
 		shouldCancel = true;
 	}
+
+	void StateFactory::setStatistics(LoadStatistics *statistics) {
+		this->statistics = statistics;
+	}
+
+	QSet<QByteArray> StateFactory::requiredSections() {
+		return { "date", "country", "fleet", "ship_design", "ships" };
+	}
 }
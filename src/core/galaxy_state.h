@@ -20,10 +20,20 @@
 #ifndef STELLARIS_STAT_VIEWER_GALAXY_STATE_H
 #define STELLARIS_STAT_VIEWER_GALAXY_STATE_H
 
+#include <array>
+
+#include <QtCore/QHash>
 #include <QtCore/QObject>
+#include <QtCore/QSet>
 #include <QtCore/QMap>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+#include "dynamic_bitset.h"
+#include "ship_design.h"
 
 class GameTranslator;
+class LoadStatistics;
 
 namespace Parsing { struct AstNode; }
 
@@ -33,6 +43,19 @@ namespace Galaxy {
 	class Ship;
 	class ShipDesign;
 
+	/** Per-empire totals over all fleets and ships, computed once when the state is built. */
+	struct EmpireAggregates {
+		double fleetPower = 0.0;  // not counting stations
+		double fleetPowerWithStations = 0.0;
+		quint32 fleetCount = 0;
+		quint32 ownedSystems = 0;
+		std::array<quint32, static_cast<size_t>(ShipSize::INVALID) + 1> shipsBySize{};
+		quint32 technologyCount = 0;
+		quint32 uniqueTechnologies = 0;  // researched by no other empire
+
+		inline quint32 ships(ShipSize size) const { return shipsBySize[static_cast<size_t>(size)]; }
+	};
+
 	class State : public QObject {
 		Q_OBJECT
 		/* No destructor necessary: Empire, etc. all inherit from QObject, and their
@@ -46,13 +69,30 @@ namespace Galaxy {
 		const QMap<qint64, Fleet *> &getFleets() const;
 		const QMap<qint64, Ship *> &getShips() const;
 		const QMap<qint64, ShipDesign *> &getShipDesigns() const;
+		/** Get the aggregates for an empire of this state. */
+		const EmpireAggregates &getAggregates(const Empire *empire) const;
+		/** Every technology researched by any empire, indexed by the ids used in Empire::getTechnologies(). */
+		const QStringList &getTechnologyNames() const;
+		/** Returns -1 if no empire has researched the technology. */
+		int getTechnologyId(const QString &name) const;
+		/** Number of empires that have researched each technology, by id. */
+		const QVector<int> &getTechnologyHolderCounts() const;
 	private:
+		int internTechnology(const char *name);
+
 		QString date;
 		QMap<qint64, Empire *> empires;
 		QMap<qint64, Fleet *> fleets;
 		QMap<qint64, Ship *> ships;
 		QMap<qint64, ShipDesign *> shipDesigns;
+		// indexed by Empire::getOrdinal()
+		QVector<EmpireAggregates> aggregates;
+		QStringList technologyNames;
+		QHash<QString, int> technologyIds;
+		QHash<const char *, int> pooledTechnologyIds;  // by the parser's pooled names, while reading the empires
+		QVector<int> technologyHolders;
 
+		friend class Empire;
 		friend class StateFactory;
 	};
 
@@ -61,10 +101,20 @@ namespace Galaxy {
 	public:
 		State *createFromAst(const Parsing::AstNode *tree, const GameTranslator* translator, QObject *parent = nullptr);
 		void cancel();
+		/** Record how long each section of the save takes to read in `statistics' (may be nullptr). */
+		void setStatistics(LoadStatistics *statistics);
+		/** The top-level entries of a save that createFromAst() reads; all others may be left out of the tree. */
+		static QSet<QByteArray> requiredSections();
 	signals:
 		void progress(StateFactory *factory, int current, int max);
+		/** Everything needed from `section', a top-level entry of the tree, has been read. Connect with
+		 *  Qt::DirectConnection to free it (see Parser::releaseSection()) before the next one is read --
+		 *  or, if it is lazy, parsed. */
+		void sectionFinished(const Parsing::AstNode *section);
 	private:
+		static void computeAggregates(State *state);
 		bool shouldCancel = false;
+		LoadStatistics *statistics = nullptr;
 	};
 }
 
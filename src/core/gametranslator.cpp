@@ -17,9 +17,68 @@
 
 #include "gametranslator.h"
 
-#include <QtCore/QDirIterator>
-#include <QtCore/QRegularExpression>
-#include <QtCore/QTextStream>
+#include <cstring>
+
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QVector>
+
+// Bump whenever the cache layout or the meaning of its contents changes.
+static const quint32 cacheMagic = 0x53535654;  // "SSVT"
+static const quint32 cacheVersion = 2;
+
+typedef QVector<QPair<QString, QString>> TranslationList;
+
+static inline bool isKeyChar(char c) {
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '.' || c == '_';
+}
+
+/* @p Reading YML localization files.
+ * Fortunately, the game's localization files use only the simplest form of YML. The files are
+ * laid out like so:
+ * l_LANGUAGE:
+ *  KEY:0 "Value"
+ * i.e. exactly one space, the key, a colon with an optional version digit, a space, and the
+ * quoted value, which runs up to the final quote on the line. Anything else (headers, comments,
+ * lines that end in a comment) is skipped. This scanner runs on the raw UTF-8 bytes and only
+ * decodes the parts it keeps.
+ */
+static TranslationList readSingleTranslationFile(const QString &fileName) {
+	TranslationList result;
+	QFile f(fileName);
+	if (!f.open(QIODevice::ReadOnly)) return result;
+	const QByteArray content(f.readAll());
+	f.close();
+
+	const char *pos = content.constData();
+	const char *end = pos + content.size();
+	while (pos < end) {
+		const char *lineEnd = static_cast<const char *>(memchr(pos, '\n', end - pos));
+		if (!lineEnd) lineEnd = end;
+		const char *next = lineEnd + (lineEnd < end ? 1 : 0);
+		if (lineEnd > pos && lineEnd[-1] == '\r') lineEnd--;
+
+		const char *p = pos;
+		pos = next;
+		if (p == lineEnd || *p++ != ' ') continue;
+		const char *keyBegin = p;
+		while (p < lineEnd && isKeyChar(*p)) p++;
+		const char *keyEnd = p;
+		if (keyEnd == keyBegin || p == lineEnd || *p++ != ':') continue;
+		if (p < lineEnd && (*p == '0' || *p == '1')) p++;
+		if (p == lineEnd || *p++ != ' ') continue;
+		if (p == lineEnd || *p++ != '"') continue;
+		// the value must be non-empty and the line must end in a quote
+		if (lineEnd - p < 2 || lineEnd[-1] != '"') continue;
+		result.append(qMakePair(QString::fromUtf8(keyBegin, keyEnd - keyBegin), QString::fromUtf8(p, lineEnd - 1 - p)));
+	}
+	return result;
+}
 
 GameTranslator::GameTranslator(const QString &gameFolder, const QString &language, QObject *parent)
 		: QObject(parent), gameDirectory(QDir(gameFolder)), language(language) {
@@ -31,11 +90,37 @@ const QString &GameTranslator::getLanguage() const {
 }
 
 QString GameTranslator::getTranslationOf(const QString &key) const {
-	return translations.value(key, key);
+	{
+		QReadLocker locker(&lock);
+		auto it = translations.constFind(key);
+		if (it == translations.cend()) return key;
+		if (it->resolved) return it->text;
+	}
+	QWriteLocker locker(&lock);
+	auto it = translations.find(key);
+	if (it == translations.end()) return key;
+	return resolve(*it, 0);
+}
+
+NameTemplate GameTranslator::getNameTemplate(const QString &key) const {
+	{
+		QReadLocker locker(&lock);
+		auto it = nameTemplates.constFind(key);
+		if (it != nameTemplates.cend()) return it.value();
+	}
+	NameTemplate parsed(getTranslationOf(key));
+	QWriteLocker locker(&lock);
+	nameTemplates.insert(key, parsed);
+	return parsed;
+}
+
+void GameTranslator::insertTranslation(const QString &key, const QString &text) {
+	translations.insert(key, { text, !text.contains(QLatin1Char('$')) });
 }
 
 int GameTranslator::setLanguage(const QString &newLanguage) {
 	translations.clear();
+	nameTemplates.clear();
 	language = newLanguage;
 	if (newLanguage != "") readTranslationFilesForLanguage();
 	return translations.count();
@@ -43,6 +128,7 @@ int GameTranslator::setLanguage(const QString &newLanguage) {
 
 int GameTranslator::setGameFolder(const QString &newFolder) {
 	translations.clear();
+	nameTemplates.clear();
 	gameDirectory = newFolder;
 	if (newFolder != "") readTranslationFilesForLanguage();
 	return translations.count();
@@ -50,55 +136,113 @@ int GameTranslator::setGameFolder(const QString &newFolder) {
 
 int GameTranslator::setFolderAndLanguage(const QString &newFolder, const QString &newLanguage) {
 	translations.clear();
+	nameTemplates.clear();
 	gameDirectory = newFolder;
 	language = newLanguage;
 	if (newFolder != "" && newLanguage != "") readTranslationFilesForLanguage();
 	return translations.count();
 }
 
-void GameTranslator::fixupStrings() {
-	QRegularExpression matchexpr("\\$([a-zA-Z0-9._]+)\\$");
-	for (auto it = translations.begin(); it != translations.end(); it++) {
-		QString backup(it.value());
-		QRegularExpressionMatchIterator matchit = matchexpr.globalMatch(backup);
-		while (matchit.hasNext()) {
-			QRegularExpressionMatch match = matchit.next();
-			if (translations.contains(match.captured(1))) {
-				it.value().replace(match.captured(0), translations[match.captured(1)]);
-			}
+// Replace every $KEY$ reference in the translation with the (resolved) translation of KEY, and
+// remember the result. References to keys that don't exist are left alone. Must be called with
+// the lock held for writing.
+const QString &GameTranslator::resolve(Translation &translation, int depth) const {
+	if (translation.resolved) return translation.text;
+	const QString value = translation.text;  // a copy, as nested calls may already update the entry
+	QString result;
+	qsizetype copiedUpTo = 0;
+	qsizetype dollar = value.indexOf(QLatin1Char('$'));
+	while (dollar >= 0) {
+		qsizetype keyEnd = dollar + 1;
+		while (keyEnd < value.size() && value[keyEnd].unicode() < 128 && isKeyChar(value[keyEnd].toLatin1())) keyEnd++;
+		if (keyEnd == dollar + 1 || keyEnd == value.size() || value[keyEnd] != QLatin1Char('$')) {
+			// not a reference, but a later '$' might start one
+			dollar = value.indexOf(QLatin1Char('$'), dollar + 1);
+			continue;
+		}
+		auto replacement = translations.find(value.mid(dollar + 1, keyEnd - dollar - 1));
+		if (replacement != translations.end()) {
+			result.append(QStringView(value).mid(copiedUpTo, dollar - copiedUpTo));
+			// guard against reference cycles
+			result.append(depth < 8 ? resolve(*replacement, depth + 1) : replacement->text);
+			copiedUpTo = keyEnd + 1;
 		}
+		dollar = value.indexOf(QLatin1Char('$'), keyEnd + 1);
 	}
+	if (copiedUpTo != 0) {
+		result.append(QStringView(value).mid(copiedUpTo));
+		translation.text = result;
+	}
+	translation.resolved = true;
+	return translation.text;
 }
 
 void GameTranslator::readTranslationFilesForLanguage() {
 	QDir localizationDir(gameDirectory.absoluteFilePath("localisation/") + language);
+	const QFileInfoList files = localizationDir.entryInfoList(QDir::Files, QDir::Name);
 
-	QDirIterator it(localizationDir);
-	while (it.hasNext()) {
-		QFile currentFile(it.next());
-		readSingleTranslationFile(&currentFile);
+	// The cache is only valid for exactly this set of files in exactly this state.
+	QCryptographicHash keyHash(QCryptographicHash::Sha1);
+	keyHash.addData(localizationDir.absolutePath().toUtf8());
+	for (const QFileInfo &file : files) {
+		keyHash.addData(file.fileName().toUtf8());
+		keyHash.addData(QByteArray::number(file.size()));
+		keyHash.addData(QByteArray::number(file.lastModified().toMSecsSinceEpoch()));
+	}
+	const QByteArray cacheKey(keyHash.result());
+	QString cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+	QString cacheFile;
+	if (!cacheDir.isEmpty()) {
+		QByteArray folderId(QCryptographicHash::hash(localizationDir.absolutePath().toUtf8(), QCryptographicHash::Sha1).toHex().left(16));
+		cacheFile = QDir(cacheDir).absoluteFilePath(QStringLiteral("translations-%1-%2.bin").arg(language, QString::fromLatin1(folderId)));
+		if (readCache(cacheFile, cacheKey)) return;
 	}
-	fixupStrings();
+
+	QStringList fileNames;
+	for (const QFileInfo &file : files) fileNames.append(file.absoluteFilePath());
+	// Files are scanned in parallel, but merged in name order so that later files win consistently.
+	const QList<TranslationList> perFile = QtConcurrent::blockingMapped(fileNames, readSingleTranslationFile);
+	for (const TranslationList &list : perFile) {
+		for (const auto &entry : list) insertTranslation(entry.first, entry.second);
+	}
+
+	if (!cacheFile.isEmpty()) writeCache(cacheFile, cacheKey);
 }
 
-void GameTranslator::readSingleTranslationFile(QFile *f) {
-	if (!(f->exists())) return;
-	if (!(f->open(QIODevice::ReadOnly | QIODevice::Text))) return;
-
-	/* @p Reading YML localization files with Regular Expressions.
-	 * Fortunately, the game's localization files use only the simplest form of YML, so
-	 * this expression is almost surprisingly simple. The files are laid out like so:
-	 * l_LANGUAGE:
-	 *  KEY:0 "Value"
-	 * Note that this implementation discards any line that ends in a comment, but I am
-	 * not aware of comments appearing on the end of useful lines: they seem to always
-	 * reside in lines of their own.
-	 */
-	QRegularExpression matchexpr("^ ([a-zA-Z0-9._]+):[01]? \"(.+)\"$", QRegularExpression::MultilineOption);
-	QRegularExpressionMatchIterator it = matchexpr.globalMatch(f->readAll());
-	while (it.hasNext()) {
-		QRegularExpressionMatch line = it.next();
-		translations[line.captured(1)] = line.captured(2);
+bool GameTranslator::readCache(const QString &cacheFile, const QByteArray &cacheKey) {
+	QFile f(cacheFile);
+	if (!f.open(QIODevice::ReadOnly)) return false;
+	QDataStream in(&f);
+	in.setVersion(QDataStream::Qt_6_0);
+	quint32 magic, version;
+	QByteArray storedKey;
+	in >> magic >> version;
+	if (magic != cacheMagic || version != cacheVersion) return false;
+	in >> storedKey;
+	if (storedKey != cacheKey) return false;
+	quint32 count;
+	in >> count;
+	translations.reserve(count);
+	QString key, text;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+		in >> key >> text;
+		insertTranslation(key, text);
+	}
+	if (in.status() != QDataStream::Ok) {
+		translations.clear();
+		return false;
 	}
-	f->close();
-}
\ No newline at end of file
+	return true;
+}
+
+void GameTranslator::writeCache(const QString &cacheFile, const QByteArray &cacheKey) const {
+	QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+	QSaveFile f(cacheFile);
+	if (!f.open(QIODevice::WriteOnly)) return;
+	QDataStream out(&f);
+	out.setVersion(QDataStream::Qt_6_0);
+	// Only unresolved texts are stored; this runs before any lookups could have expanded them.
+	out << cacheMagic << cacheVersion << cacheKey << quint32(translations.size());
+	for (auto it = translations.cbegin(); it != translations.cend(); it++) out << it.key() << it->text;
+	if (out.status() == QDataStream::Ok) f.commit();
+}
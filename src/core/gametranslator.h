@@ -20,28 +20,43 @@
 #define STELLARIS_STAT_VIEWER_GAMETRANSLATOR_H
 
 #include <QtCore/QDir>
-#include <QtCore/QMap>
+#include <QtCore/QHash>
 #include <QtCore/QObject>
+#include <QtCore/QReadWriteLock>
 #include <QtCore/QString>
-class QFile;
+
+#include "nametemplate.h"
 
 class GameTranslator : public QObject {
 	Q_OBJECT
 public:
 	GameTranslator(const QString &gameFolder, const QString &language = QString(), QObject *parent = nullptr);
 	const QString &getLanguage() const;
+	/** Look up the translation of `key', or return the key itself if there is none. Thread-safe. */
 	QString getTranslationOf(const QString &key) const;
+	/** Get the translation of `key' as a pre-parsed name template. Thread-safe. */
+	NameTemplate getNameTemplate(const QString &key) const;
 	int setGameFolder(const QString &newFolder);
 	int setLanguage(const QString &newLanguage);
 	int setFolderAndLanguage(const QString &newFolder, const QString &newLanguage);
 private:
-	void fixupStrings();
+	struct Translation {
+		QString text;
+		bool resolved;  // whether $KEY$ references in text have been expanded already
+	};
+
+	void insertTranslation(const QString &key, const QString &text);
+	const QString &resolve(Translation &translation, int depth) const;
 	void readTranslationFilesForLanguage();
-	void readSingleTranslationFile(QFile *f);
+	bool readCache(const QString &cacheFile, const QByteArray &cacheKey);
+	void writeCache(const QString &cacheFile, const QByteArray &cacheKey) const;
 
 	QDir gameDirectory;
 	QString language;
-	QMap<QString, QString> translations;
+	// Entries are expanded on first use, so lookups may modify the table.
+	mutable QHash<QString, Translation> translations;
+	mutable QHash<QString, NameTemplate> nameTemplates;
+	mutable QReadWriteLock lock;
 };
 
 #endif //STELLARIS_STAT_VIEWER_GAMETRANSLATOR_H
\ No newline at end of file
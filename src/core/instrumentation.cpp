@@ -0,0 +1,94 @@
+/* core/instrumentation.cpp: Timing and counting the stages of loading a save.
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "instrumentation.h"
+
+#include <QtCore/QTextStream>
+
+qint64 LoadStatistics::totalTime() const {
+	qint64 total = 0;
+	for (qint64 time : times) total += time;
+	return total;
+}
+
+bool LoadStatistics::isEmpty() const {
+	for (qint64 time : times) if (time) return false;
+	for (qint64 value : counters) if (value) return false;
+	return true;
+}
+
+const char *LoadStatistics::phaseName(Phase phase) {
+	switch (phase) {
+		case Inflate: return "inflate";
+		case Lex: return "lex";
+		case Parse: return "parse";
+		case BuildEmpires: return "build_empires";
+		case BuildFleets: return "build_fleets";
+		case BuildShipDesigns: return "build_ship_designs";
+		case BuildShips: return "build_ships";
+		case Aggregates: return "aggregates";
+		case Serialize: return "serialize";
+		case PhaseCount: break;
+	}
+	return "unknown";
+}
+
+const char *LoadStatistics::counterName(Counter counter) {
+	switch (counter) {
+		case FileBytes: return "file_bytes";
+		case GamestateBytes: return "gamestate_bytes";
+		case Tokens: return "tokens";
+		case Nodes: return "nodes";
+		case ArenaBlocks: return "arena_blocks";
+		case CounterCount: break;
+	}
+	return "unknown";
+}
+
+QJsonObject LoadStatistics::toJson() const {
+	QJsonObject timesMs, counterValues;
+	for (int phase = 0; phase < PhaseCount; phase++) {
+		if (times[phase]) timesMs.insert(phaseName(Phase(phase)), times[phase] / 1e6);
+	}
+	for (int counter = 0; counter < CounterCount; counter++) {
+		counterValues.insert(counterName(Counter(counter)), counters[counter]);
+	}
+	QJsonObject result;
+	result.insert("total_ms", totalTime() / 1e6);
+	result.insert("times_ms", timesMs);
+	result.insert("counters", counterValues);
+	return result;
+}
+
+QString LoadStatistics::toText() const {
+	QString result;
+	QTextStream out(&result);
+	const qint64 total = totalTime();
+	for (int phase = 0; phase < PhaseCount; phase++) {
+		if (!times[phase]) continue;
+		out << qSetFieldWidth(20) << Qt::left << phaseName(Phase(phase)) << qSetFieldWidth(12) << Qt::right
+		    << QString::number(times[phase] / 1e6, 'f', 2) << qSetFieldWidth(0) << " ms"
+		    << qSetFieldWidth(8) << QString::number(100.0 * times[phase] / total, 'f', 1) << qSetFieldWidth(0) << " %\n";
+	}
+	out << qSetFieldWidth(20) << Qt::left << "total" << qSetFieldWidth(12) << Qt::right
+	    << QString::number(total / 1e6, 'f', 2) << qSetFieldWidth(0) << " ms\n";
+	for (int counter = 0; counter < CounterCount; counter++) {
+		out << qSetFieldWidth(20) << Qt::left << counterName(Counter(counter)) << qSetFieldWidth(12) << Qt::right
+		    << counters[counter] << qSetFieldWidth(0) << "\n";
+	}
+	return result;
+}
@@ -0,0 +1,101 @@
+/* core/instrumentation.h: Timing and counting the stages of loading a save (header file)
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#ifndef STELLARIS_STAT_VIEWER_INSTRUMENTATION_H
+#define STELLARIS_STAT_VIEWER_INSTRUMENTATION_H
+
+#include <array>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMetaType>
+#include <QtCore/QString>
+
+/** Where the time went while loading one save, and how much there was to get through.
+ *
+ * Every stage of the pipeline takes an optional pointer to an instance and adds to it; passing
+ * nullptr (the default everywhere) turns the bookkeeping off. An instance is not thread-safe,
+ * but a load only ever runs on a single thread.
+ */
+class LoadStatistics {
+public:
+	enum Phase {
+		Inflate,
+		Lex,
+		Parse,  // not counting the time spent in the lexer
+		BuildEmpires,
+		BuildFleets,
+		BuildShipDesigns,
+		BuildShips,
+		Aggregates,
+		Serialize,
+		PhaseCount
+	};
+	enum Counter {
+		FileBytes,  // size of the file as read from disk
+		GamestateBytes,  // size of the gamestate after inflating it
+		Tokens,
+		Nodes,
+		ArenaBlocks,  // blocks of nodes allocated by the parser
+		CounterCount
+	};
+
+	inline void addTime(Phase phase, qint64 nsecs) { times[phase] += nsecs; }
+	inline void add(Counter counter, qint64 amount) { counters[counter] += amount; }
+	inline qint64 time(Phase phase) const { return times[phase]; }
+	inline qint64 value(Counter counter) const { return counters[counter]; }
+	/** The sum of all phases, in nanoseconds. */
+	qint64 totalTime() const;
+	/** Whether nothing has been recorded yet. */
+	bool isEmpty() const;
+
+	/** Short, untranslated names, as used in toJson(). */
+	static const char *phaseName(Phase phase);
+	static const char *counterName(Counter counter);
+
+	/** { "times_ms": { phase: ms, ... }, "counters": { counter: n, ... } }, leaving out phases that never ran. */
+	QJsonObject toJson() const;
+	/** A plain-text table of the same, for the console. */
+	QString toText() const;
+
+private:
+	std::array<qint64, PhaseCount> times {};
+	std::array<qint64, CounterCount> counters {};
+};
+Q_DECLARE_METATYPE(LoadStatistics)
+
+/** Adds the time from its construction to its destruction to one phase of a LoadStatistics.
+ *  Does nothing at all if that is nullptr. */
+class ScopedTimer {
+	Q_DISABLE_COPY(ScopedTimer)
+public:
+	inline ScopedTimer(LoadStatistics *statistics, LoadStatistics::Phase phase) : statistics(statistics), phase(phase) {
+		if (statistics) timer.start();
+	}
+	inline ~ScopedTimer() {
+		if (statistics) statistics->addTime(phase, timer.nsecsElapsed());
+	}
+
+private:
+	LoadStatistics *statistics;
+	LoadStatistics::Phase phase;
+	QElapsedTimer timer;
+};
+
+#endif //STELLARIS_STAT_VIEWER_INSTRUMENTATION_H
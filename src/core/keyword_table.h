@@ -0,0 +1,107 @@
+/* core/keyword_table.h: Compile-time perfect hash tables for fixed sets of keywords.
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#ifndef STELLARIS_STAT_VIEWER_KEYWORD_TABLE_H
+#define STELLARIS_STAT_VIEWER_KEYWORD_TABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace Parsing {
+	/** Maps a fixed set of strings to values without any string comparisons beyond the final one.
+	 *
+	 * The table is built by the compiler: it searches for a seed for which the (seeded FNV-1a) hashes
+	 * of all keys land in distinct slots, so a lookup is one hash, one slot and one comparison.
+	 * Declare instances as `static constexpr` so that the search never happens at run time.
+	 */
+	template <typename Value, std::size_t N>
+	class KeywordTable {
+	public:
+		struct Entry {
+			std::string_view key;
+			Value value;
+		};
+
+		constexpr explicit KeywordTable(const std::array<Entry, N> &entries) : slots(), seed(0) {
+			for (std::uint32_t candidate = 1; candidate != 0; candidate++) {
+				if (tryBuild(entries, candidate)) {
+					seed = candidate;
+					return;
+				}
+			}
+		}
+
+		constexpr std::optional<Value> find(std::string_view key) const {
+			const Slot &slot = slots[slotOf(key, seed)];
+			if (slot.used && slot.entry.key == key) return slot.entry.value;
+			return std::nullopt;
+		}
+
+		constexpr bool contains(std::string_view key) const {
+			return find(key).has_value();
+		}
+
+		/** Returns the value for `key', or `fallback' if the key is not in the table. */
+		constexpr Value value(std::string_view key, Value fallback) const {
+			return find(key).value_or(fallback);
+		}
+
+	private:
+		struct Slot {
+			Entry entry {};
+			bool used = false;
+		};
+
+		static constexpr std::size_t slotCount() {
+			// A load factor of at most 1/4 keeps the seed search short.
+			std::size_t count = 1;
+			while (count < N * 4) count *= 2;
+			return count;
+		}
+
+		static constexpr std::size_t slotOf(std::string_view key, std::uint32_t seed) {
+			std::uint32_t hash = 2166136261u ^ seed;
+			for (char c : key) {
+				hash ^= static_cast<unsigned char>(c);
+				hash *= 16777619u;
+			}
+			hash ^= hash >> 15;
+			return hash & (slotCount() - 1);
+		}
+
+		constexpr bool tryBuild(const std::array<Entry, N> &entries, std::uint32_t candidate) {
+			for (Slot &slot : slots) slot = Slot();
+			for (const Entry &entry : entries) {
+				Slot &slot = slots[slotOf(entry.key, candidate)];
+				if (slot.used) return false;
+				slot.entry = entry;
+				slot.used = true;
+			}
+			return true;
+		}
+
+		std::array<Slot, slotCount()> slots;
+		std::uint32_t seed;
+	};
+}
+
+#endif //STELLARIS_STAT_VIEWER_KEYWORD_TABLE_H
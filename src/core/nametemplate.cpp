@@ -0,0 +1,150 @@
+/* core/nametemplate.cpp: Pre-parsed localized name formats.
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nametemplate.h"
+
+#include <utility>
+
+#include <QtCore/QRegularExpression>
+
+// These are what names used to be put together with; the segments are found the same way.
+static const QString anglesPattern(QStringLiteral("<(.*?)>"));
+static const QString squaresPattern(QStringLiteral("\\[(.*?)\\]"));
+// Substituted values may refer to themselves, so don't go on rescanning forever, or until memory runs out.
+static const int maxSubstitutions = 32;
+static const qsizetype maxRescannedLength = 1024;
+
+static bool containsBrackets(const QString &text) {
+	for (QChar c : text) {
+		if (c == QLatin1Char('<') || c == QLatin1Char('>') || c == QLatin1Char('[') || c == QLatin1Char(']')) return true;
+	}
+	return false;
+}
+
+NameTemplate::NameTemplate(const QString &format) : format(format) {
+	// Every <name> is a placeholder.
+	const QRegularExpression angles(anglesPattern);
+	qsizetype pos = 0;
+	QRegularExpressionMatchIterator it = angles.globalMatch(format);
+	while (it.hasNext()) {
+		const QRegularExpressionMatch match = it.next();
+		appendLiteral(format.mid(pos, match.capturedStart() - pos));
+		segments.append({ QString(), match.captured(1).toUtf8(), true });
+		// Rescanning after each substitution would have found something else here.
+		if (match.captured(1).contains(QLatin1Char('<'))) bracketsOnlyInPlaceholders = false;
+		pos = match.capturedEnd();
+	}
+	appendLiteral(format.mid(pos));
+
+	// Only the first [name] is, but wherever it occurs.
+	const QRegularExpression squares(squaresPattern);
+	QString square;
+	QByteArray squareName;
+	for (const Segment &segment : std::as_const(segments)) {
+		if (segment.isVariable) continue;
+		const QRegularExpressionMatch match = squares.match(segment.literal);
+		if (match.hasMatch()) {
+			square = match.captured(0);
+			squareName = match.captured(1).toUtf8();
+			break;
+		}
+	}
+
+	if (!square.isEmpty()) {
+		QVector<Segment> literalsSplit;
+		literalsSplit.reserve(segments.size() + 2);
+		std::swap(segments, literalsSplit);
+		for (const Segment &segment : std::as_const(literalsSplit)) {
+			if (segment.isVariable) {
+				segments.append(segment);
+				continue;
+			}
+			qsizetype from = 0, at;
+			while ((at = segment.literal.indexOf(square, from)) >= 0) {
+				appendLiteral(segment.literal.mid(from, at - from));
+				segments.append({ QString(), squareName, true });
+				from = at + square.size();
+			}
+			appendLiteral(segment.literal.mid(from));
+		}
+	}
+
+	// Any brackets left over might pair up with substituted text, or with each other across a placeholder.
+	for (const Segment &segment : std::as_const(segments)) {
+		if (!segment.isVariable && containsBrackets(segment.literal)) bracketsOnlyInPlaceholders = false;
+	}
+}
+
+void NameTemplate::appendLiteral(const QString &text) {
+	if (!text.isEmpty()) segments.append({ text, QByteArray(), false });
+}
+
+static const QString *findValue(const NameTemplate::Variables &variables, const char *name) {
+	const QString *value = nullptr;
+	for (const NameTemplate::Variable &variable : variables) {
+		if (qstrcmp(variable.name, name) == 0) value = &variable.value;
+	}
+	return value;
+}
+
+QString NameTemplate::apply(const Variables &variables) const {
+	if (!bracketsOnlyInPlaceholders) return applyByRescanning(variables);
+
+	// Look up all variables first so that the result can be put together with a single allocation.
+	QVarLengthArray<const QString *, 8> values;
+	qsizetype totalSize = 0;
+	for (const Segment &segment : segments) {
+		if (segment.isVariable) {
+			const QString *value = findValue(variables, segment.variable.constData());
+			if (value && containsBrackets(*value)) return applyByRescanning(variables);
+			values.append(value);
+			if (value) totalSize += value->size();
+		} else {
+			totalSize += segment.literal.size();
+		}
+	}
+
+	QString result;
+	result.reserve(totalSize);
+	qsizetype nextValue = 0;
+	for (const Segment &segment : segments) {
+		if (!segment.isVariable) {
+			result.append(segment.literal);
+		} else if (const QString *value = values[nextValue++]) {
+			result.append(*value);
+		}
+	}
+	return result;
+}
+
+QString NameTemplate::applyByRescanning(const Variables &variables) const {
+	const QRegularExpression angles(anglesPattern);
+	const QRegularExpression squares(squaresPattern);
+	auto valueOf = [&variables](const QRegularExpressionMatch &match) {
+		const QString *value = findValue(variables, match.captured(1).toUtf8().constData());
+		return value ? *value : QString();
+	};
+
+	QString result(format);
+	QRegularExpressionMatch match;
+	for (int i = 0; i < maxSubstitutions && result.size() < maxRescannedLength && (match = angles.match(result)).hasMatch(); i++) {
+		result.replace(match.captured(0), valueOf(match));
+	}
+	match = squares.match(result);
+	if (match.hasMatch()) result.replace(match.captured(0), valueOf(match));
+	return result;
+}
@@ -0,0 +1,67 @@
+/* core/nametemplate.h: Pre-parsed localized name formats (header file)
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#ifndef STELLARIS_STAT_VIEWER_NAMETEMPLATE_H
+#define STELLARIS_STAT_VIEWER_NAMETEMPLATE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QVarLengthArray>
+#include <QtCore/QVector>
+
+/** A name format such as "<prefix> [adjective] Republic", split into literal text and placeholders.
+ *
+ * Every <name> is a placeholder. Of the [name]s, only the first one (and any repetitions of it) is,
+ * all others are kept as literal text. This is what the game's generated empire names need.
+ *
+ * Names used to be put together by substituting one placeholder at a time and searching the whole string
+ * again, which also expands placeholders that come from substituted values. Where that could give a
+ * different result -- a value or stray literal text containing brackets -- apply() still does just that.
+ */
+class NameTemplate {
+public:
+	NameTemplate() = default;
+	explicit NameTemplate(const QString &format);
+
+	/** A variable that may be filled in, with its value already translated. */
+	struct Variable {
+		const char *name;
+		QString value;
+	};
+	typedef QVarLengthArray<Variable, 8> Variables;
+
+	/** Fill in each placeholder with the value of its variable. Where there are several of the same name,
+	 *  the last one counts; placeholders without a variable are left empty. */
+	QString apply(const Variables &variables) const;
+
+private:
+	struct Segment {
+		QString literal;
+		QByteArray variable;
+		bool isVariable;
+	};
+	void appendLiteral(const QString &text);
+	QString applyByRescanning(const Variables &variables) const;
+
+	QString format;
+	QVector<Segment> segments;
+	bool bracketsOnlyInPlaceholders = true;
+};
+
+#endif //STELLARIS_STAT_VIEWER_NAMETEMPLATE_H
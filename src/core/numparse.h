@@ -0,0 +1,124 @@
+/* core/numparse.h: Locale-independent parsing of the numbers found in game files.
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#ifndef STELLARIS_STAT_VIEWER_NUMPARSE_H
+#define STELLARIS_STAT_VIEWER_NUMPARSE_H
+
+#include <cstdint>
+#include <limits>
+
+#include <QtCore/QByteArray>
+
+namespace Parsing {
+	/** Parses an optional minus sign followed by decimal digits from [begin, end), stopping at the first
+	 *  character that is not a digit, like strtoll does. Values out of range are clamped to the limits
+	 *  of int64_t, also like strtoll. Returns where parsing stopped, or `begin' if there were no digits. */
+	inline const char *parseInt(const char *begin, const char *end, int64_t *result) {
+		const char *p = begin;
+		const bool negative = p != end && *p == '-';
+		if (negative) p++;
+		const char *digits = p;
+		uint64_t value = 0;
+		bool overflow = false;
+		for (; p != end && static_cast<unsigned char>(*p - '0') < 10; p++) {
+			const uint64_t digit = static_cast<unsigned char>(*p - '0');
+			overflow |= value > (UINT64_MAX - digit) / 10;
+			value = value * 10 + digit;
+		}
+		if (p == digits) return begin;
+
+		const uint64_t limit = negative ? uint64_t(INT64_MAX) + 1 : uint64_t(INT64_MAX);
+		if (overflow || value > limit) value = limit;
+		*result = negative ? static_cast<int64_t>(0 - value) : static_cast<int64_t>(value);
+		return p;
+	}
+
+	/** Parses a decimal number, i.e. an optional minus sign, digits, an optional fraction and an optional
+	 *  exponent, from [begin, end), stopping at the first character that doesn't fit, like strtod does.
+	 *  The result is the same double strtod gives, but doesn't depend on the C locale. Numbers with at
+	 *  most 15 significant digits, which is all the game ever writes, are converted without any rounding
+	 *  error by a single multiplication or division; the rest are left to Qt's exact conversion.
+	 *  Returns where parsing stopped, or `begin' if there were no digits. */
+	inline const char *parseDouble(const char *begin, const char *end, double *result) {
+		// Powers of ten up to 10^22 are exactly representable as doubles.
+		static constexpr double powersOfTen[] = {
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+		const char *p = begin;
+		const bool negative = p != end && *p == '-';
+		if (negative) p++;
+
+		uint64_t mantissa = 0;
+		int significantDigits = 0;
+		int exponent = 0;
+		bool haveDigits = false;
+		for (; p != end && static_cast<unsigned char>(*p - '0') < 10; p++) {
+			haveDigits = true;
+			if (mantissa == 0 && *p == '0') continue;  // leading zeros aren't significant
+			if (significantDigits < 19) mantissa = mantissa * 10 + (*p - '0');
+			else exponent++;
+			significantDigits++;
+		}
+		if (p != end && *p == '.') {
+			p++;
+			for (; p != end && static_cast<unsigned char>(*p - '0') < 10; p++) {
+				haveDigits = true;
+				if (mantissa == 0 && *p == '0') {
+					exponent--;
+					continue;
+				}
+				if (significantDigits < 19) {
+					mantissa = mantissa * 10 + (*p - '0');
+					exponent--;
+				}
+				significantDigits++;
+			}
+		}
+		if (!haveDigits) return begin;
+
+		if (p != end && (*p == 'e' || *p == 'E')) {
+			// Only part of the number if digits follow.
+			const char *exponentBegin = p + 1;
+			const bool negativeExponent = exponentBegin != end && *exponentBegin == '-';
+			if (exponentBegin != end && (*exponentBegin == '-' || *exponentBegin == '+')) exponentBegin++;
+			const char *q = exponentBegin;
+			int exponentValue = 0;
+			for (; q != end && static_cast<unsigned char>(*q - '0') < 10; q++) {
+				if (exponentValue < 100000) exponentValue = exponentValue * 10 + (*q - '0');
+			}
+			if (q != exponentBegin) {
+				exponent += negativeExponent ? -exponentValue : exponentValue;
+				p = q;
+			}
+		}
+
+		if (significantDigits <= 19 && mantissa < (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+			// Both operands are exact, so the result is correctly rounded.
+			const double value = static_cast<double>(mantissa);
+			const double magnitude = exponent < 0 ? value / powersOfTen[-exponent] : value * powersOfTen[exponent];
+			*result = negative ? -magnitude : magnitude;
+		} else {
+			*result = QByteArray::fromRawData(begin, static_cast<int>(p - begin)).toDouble();
+		}
+		return p;
+	}
+}
+
+#endif //STELLARIS_STAT_VIEWER_NUMPARSE_H
@@ -18,15 +18,33 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include "parser.h"
 
+#include <algorithm>
+#include <charconv>
 #include <stack>
+#include <string_view>
 #include <utility>
 
 #include <stdio.h>
-#include <locale.h>
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "instrumentation.h"
+#include "keyword_table.h"
+#include "numparse.h"
+#include "tracing.h"
 
 #define everyNth(which, n, what) do { if ((((which)++) % (n)) == 0) {(what); (which) = 1;} } while (0)
 
 namespace Parsing {
+	static constexpr KeywordTable<bool, 4> boolLiterals({{
+		{ "yes", true },
+		{ "YES", true },
+		{ "no", false },
+		{ "NO", false }
+	}});
+
 	// Indicates whether this AST node type can have children.
 	static inline bool typeHasChildren(NodeType t) {
 		switch (t) {
@@ -60,11 +78,15 @@ namespace Parsing {
 
 	// Iterates through our children to find the one called `name', if any.
 	AstNode* AstNode::findChildWithName(const char *name) const {
+		if (type == NT_LAZY) const_cast<AstNode *>(this)->expand();
 		if (type != NT_COMPOUND) return nullptr;
 		if (this->val.firstChild == nullptr) return nullptr;
 		AstNode *child = this->val.firstChild;
 		do {
-			if (strcmp(child->myName, name) == 0) return child;
+			if (strcmp(child->myName, name) == 0) {
+				if (child->type == NT_LAZY) child->expand();
+				return child;
+			}
 			child = child->nextSibling;
 		} while (child);
 		return nullptr;
@@ -72,6 +94,7 @@ namespace Parsing {
 
 	// Counts the children of this node.
 	int64_t AstNode::countChildren() const {
+		if (type == NT_LAZY) const_cast<AstNode *>(this)->expand();
 		if (!typeHasChildren(type)) return -1;
 		if (this->val.firstChild == nullptr) return 0;
 		int64_t childCount = 0;
@@ -83,6 +106,11 @@ namespace Parsing {
 		return childCount;
 	}
 
+	// Parses this node if that has been put off.
+	void AstNode::expand() {
+		if (type == NT_LAZY) val.lazy.owner->materialize(this);
+	}
+
 	// For debugging: print the parse tree starting at this node.
 	void printParseTree(const AstNode *tree, int indent, bool toplevel) {
 		comeagain:
@@ -103,6 +131,7 @@ namespace Parsing {
 			case NT_STRINGLIST:
 			case NT_BOOLLIST:
 			case NT_EMPTY:
+			case NT_LAZY:
 				printf("%s", tree->myName);
 				break;
 			case NT_INDETERMINATE:
@@ -207,6 +236,9 @@ namespace Parsing {
 			case NT_EMPTY:
 				printf(" (Empty)\n");
 				break;
+			case NT_LAZY:
+				printf(" (Not yet parsed)\n");
+				break;
 			case NT_INDETERMINATE:
 				Q_UNREACHABLE();
 		}
@@ -254,11 +286,14 @@ namespace Parsing {
 				return QObject::tr("Invalid double literal.");
 			case PE_CANCELLED:
 				return QObject::tr("Parsing cancelled (no error).");
+			case PE_MEMORY_BUDGET_EXCEEDED:
+				return QObject::tr("Memory budget exceeded.");
 		}
 		return QStringLiteral("??? (BUG: unknown error type.)");
 	}
 
-	MemBuf::MemBuf(char *area, size_t size) : buf(area), location(0), _size(size) {}
+	MemBuf::MemBuf(char *area, size_t size, Ownership ownership)
+		: buf(area), location(0), _size(size), owned(ownership == TakeOwnership) {}
 	MemBuf::MemBuf(const QByteArray &arr) {
 		_size = arr.size();
 		buf = static_cast<char *>(malloc(_size));
@@ -272,7 +307,58 @@ namespace Parsing {
 		location = 0;
 	}
 	MemBuf::~MemBuf() {
-		free(buf);
+		if (owned) free(buf);
+	}
+
+	void MemBuf::releasePages() {
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+		// Only whole pages within the buffer can go; the ones at either end may be shared with the heap.
+		const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+		const uintptr_t begin = (reinterpret_cast<uintptr_t>(buf) + released + pageSize - 1) & ~(pageSize - 1);
+		const uintptr_t end = (reinterpret_cast<uintptr_t>(buf) + location) & ~(pageSize - 1);
+		if (end <= begin) return;
+#ifdef Q_OS_LINUX
+		madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+#else
+		madvise(reinterpret_cast<void *>(begin), end - begin, MADV_FREE);
+#endif
+		released = end - reinterpret_cast<uintptr_t>(buf);
+#endif
+	}
+
+	const char *StringPool::intern(std::string_view str) {
+		auto found = strings.find(str);
+		if (found != strings.end()) return found->data();
+		char *copy = allocate(str.size() + 1);
+		memcpy(copy, str.data(), str.size());
+		copy[str.size()] = '\0';
+		strings.insert(std::string_view(copy, str.size()));
+		return copy;
+	}
+
+	size_t StringPool::memoryUsage() const {
+		// The set's nodes hold a string_view and the hash, plus the pointer to the next node.
+		return bytesAllocated + strings.bucket_count() * sizeof(void *)
+				+ strings.size() * (sizeof(std::string_view) + 2 * sizeof(void *));
+	}
+
+	char *StringPool::allocate(size_t size) {
+		if (size > blockSize / 4) {
+			// Rare long strings get a block of their own, so as not to waste the rest of the current one.
+			blocks.emplace_back(new char[size]);
+			bytesAllocated += size;
+			return blocks.back().get();
+		}
+		if (size > bytesLeft) {
+			blocks.emplace_back(new char[blockSize]);
+			bytesAllocated += blockSize;
+			nextFree = blocks.back().get();
+			bytesLeft = blockSize;
+		}
+		char *result = nextFree;
+		nextFree += size;
+		bytesLeft -= size;
+		return result;
 	}
 
 	Parser::Parser(Parsing::MemBuf &data, Parsing::FileType ftype, QString filename, QObject *parent)
@@ -280,7 +366,7 @@ namespace Parsing {
 
 	Parser::~Parser() {
 		for (auto *block: nodeStorageBlocks) {
-			delete[] block;
+			delete[] block;  // released sections leave nullptr behind
 		}
 	}
 
@@ -290,10 +376,179 @@ namespace Parsing {
 			nextNodeToUse = new AstNode[nodesAtOnce];
 			lastNodeInBlock = nextNodeToUse + nodesAtOnce - 1;
 			nodeStorageBlocks.push_back(nextNodeToUse);
+			liveBlocks++;
+			// Checked only here, as this is the only place where the tree grows. parse() stops at the next token.
+			if (memoryBudget >= 0 && memoryInUse() > memoryBudget) overBudget = true;
 		}
+		nodesCreated++;
 		return nextNodeToUse++;
 	}
 
+	// Skip over the value of a top-level entry that isn't wanted, without building any nodes for it.
+	// The entry's name has already been read.
+	void Parser::skipValue() {
+		Token token = getNextToken();
+		while (token.type == TT_EQUALS || token.type == TT_LT || token.type == TT_GT) token = getNextToken();
+		if (token.type == TT_OBRACE) skipToClose(1);
+	}
+
+	// Skip tokens until `depth' many open braces have been closed.
+	void Parser::skipToClose(int depth) {
+		while (depth > 0) {
+			const Token token = getNextToken();
+			if (token.type == TT_OBRACE) depth++;
+			else if (token.type == TT_CBRACE) depth--;
+		}
+	}
+
+	// Turn a node that couldn't be parsed into an empty one. Its children, if any, are left to the arena.
+	void Parser::makeEmpty(AstNode *node) {
+		node->type = NT_EMPTY;
+		node->val.firstChild = nullptr;
+		node->val.lastChild = nullptr;
+	}
+
+	void Parser::setResilient(bool resilient) {
+		this->resilient = resilient;
+	}
+
+	const std::vector<ParserError> &Parser::getErrors() const {
+		return errors;
+	}
+
+	void Parser::setSectionFilter(const QSet<QByteArray> &sections) {
+		sectionFilter = sections;
+	}
+
+	void Parser::setMemoryBudget(qint64 bytes) {
+		memoryBudget = bytes;
+	}
+
+	qint64 Parser::memoryInUse() const {
+		return qint64(liveBlocks) * nodesAtOnce * sizeof(AstNode) + strings->memoryUsage() + data.residentSize();
+	}
+
+	bool Parser::releaseSection(const AstNode *section) {
+		auto found = std::find_if(sections.begin(), sections.end(), [section](const Section &s) { return s.node == section; });
+		if (found == sections.end() || !treeRoot) return false;
+		AstNode *previous = nullptr;
+		for (AstNode *child = treeRoot->val.firstChild; child; previous = child, child = child->nextSibling) {
+			if (child != section) continue;
+			if (previous) previous->nextSibling = child->nextSibling;
+			else treeRoot->val.firstChild = child->nextSibling;
+			if (treeRoot->val.lastChild == child) treeRoot->val.lastChild = previous;
+			break;
+		}
+		for (size_t block = found->firstBlock; block < found->endBlock; block++) {
+			delete[] nodeStorageBlocks[block];
+			nodeStorageBlocks[block] = nullptr;
+			liveBlocks--;
+		}
+		for (size_t block : found->lazyBlocks) {
+			delete[] nodeStorageBlocks[block];
+			nodeStorageBlocks[block] = nullptr;
+			liveBlocks--;
+		}
+		sections.erase(found);
+		return true;
+	}
+
+	void Parser::setLazy(bool lazy) {
+		this->lazy = lazy;
+	}
+
+	// Turn the node whose value begins with `open' into a lazy one and continue reading after that value.
+	// The value is found by matching braces, which only needs to look out for strings and comments.
+	void Parser::deferValue(AstNode *node, const Token &open, uint64_t nameOffset, uint64_t nameLine) {
+		const char *text = data.data();
+		const size_t size = data.size();
+		uint64_t valueLine = open.line;
+		size_t lineStart = open.offset - open.firstChar + 1;
+		size_t pos = open.offset + 1;
+		for (int depth = 1; ; pos++) {
+			if (pos >= size) {
+				line = valueLine;
+				charPos = pos - lineStart;
+				throw ParserError{ PE_UNEXPECTED_END, {line, charPos, TT_NONE, {nullptr}} };
+			}
+			const char c = text[pos];
+			if (c == '{') {
+				depth++;
+			} else if (c == '}') {
+				if (--depth == 0) break;
+			} else if (c == '"') {
+				for (pos++; pos < size && text[pos] != '"'; pos++) {
+					if (text[pos] == '\\') pos++;
+					else if (text[pos] == '\n') { valueLine++; lineStart = pos + 1; }
+				}
+			} else if (c == '#') {
+				while (pos < size && text[pos] != '\n') pos++;
+				if (pos < size) { valueLine++; lineStart = pos + 1; }
+			} else if (c == '\n') {
+				valueLine++;
+				lineStart = pos + 1;
+			}
+		}
+		node->type = NT_LAZY;
+		node->relation = RT_EQ;
+		node->val.lazy = { this, nameOffset, pos + 1, nameLine };
+
+		// The lexer stops at opening braces in lazy mode, so it has read nothing beyond the value yet.
+		Q_ASSERT_X(lexQueue.isEmpty(), "Parser::deferValue", "tokens lexed beyond the value");
+		data.seek(pos + 1);
+		lexerDone = data.eof();
+		line = valueLine;
+		charPos = pos + 1 - lineStart;
+		totalProgress = data.tell();
+	}
+
+	// Parse a lazy node now, as an input of its own that consists of just its entry.
+	void Parser::materialize(AstNode *node) {
+		SSV_TRACE_SCOPE("Parser::materialize");
+		// Once over the budget, nothing more is parsed; the error stays as it is.
+		if (overBudget) {
+			makeEmpty(node);
+			return;
+		}
+		MemBuf entry(data.data() + node->val.lazy.begin, node->val.lazy.end - node->val.lazy.begin, MemBuf::Borrow);
+		Parser sub(entry, fileType, filename);
+		sub.line = node->val.lazy.line;
+		sub.strings = strings;
+		sub.resilient = resilient;
+		// The sub-parser adds its lexing and parsing times and counts itself. Whoever expands nodes should do
+		// so outside of any phase they are timing (as StateFactory::createFromAst() does), so that the time
+		// isn't counted twice.
+		sub.statistics = statistics;
+		if (memoryBudget >= 0) {
+			// Whatever is left of ours. The sub-parser counts the shared strings and its input as well, both of
+			// which are part of memoryInUse() already.
+			const qint64 left = memoryBudget - memoryInUse() + strings->memoryUsage() + qint64(entry.residentSize());
+			sub.memoryBudget = std::max<qint64>(left, 0);
+		}
+		AstNode *result = sub.parse();
+		errors.insert(errors.end(), sub.errors.begin(), sub.errors.end());
+		if (result && result->val.firstChild) {
+			node->type = result->val.firstChild->type;
+			node->relation = result->val.firstChild->relation;
+			node->val = result->val.firstChild->val;
+		} else {
+			latestParserError = sub.getLatestParserError();
+			if (latestParserError.etype == PE_MEMORY_BUDGET_EXCEEDED) overBudget = true;
+			makeEmpty(node);
+		}
+
+		// The new nodes become ours, and belong to the section, if any, that they were parsed for.
+		auto section = std::find_if(sections.begin(), sections.end(), [node](const Section &s) { return s.node == node; });
+		for (AstNode *block : sub.nodeStorageBlocks) {
+			if (section != sections.end()) section->lazyBlocks.push_back(nodeStorageBlocks.size());
+			nodeStorageBlocks.push_back(block);
+		}
+		liveBlocks += sub.liveBlocks;
+		nodesCreated += sub.nodesCreated;
+		tokensLexed += sub.tokensLexed;
+		sub.nodeStorageBlocks.clear();
+	}
+
 	// Represents the parser's internal state.
 	enum class State {
 		CompoundRoot,
@@ -316,46 +571,82 @@ if (things.top()->val.firstChild) { things.top()->val.lastChild->nextSibling = (
 else { things.top()->val.firstChild = (node); things.top()->val.lastChild = (node); } \
 } while (0)
 
-#define PARSE_ERROR(error) do { latestParserError = { (error), currentToken }; return nullptr; } while (0)
+	// Name a node after an integer key, keeping the number as well.
+	static inline void setIntKey(AstNode *node, int64_t key, StringPool *strings) {
+		node->keyIsInt = true;
+		node->intKey = key;
+		char digits[24];
+		const char *end = std::to_chars(digits, digits + sizeof(digits), key).ptr;
+		node->myName = strings->intern(std::string_view(digits, end - digits));
+	}
+
+// In resilient mode, errors within the main loop of parse() are recorded and recovered from (see below).
+#define RECOVERABLE_ERROR(error) do { latestParserError = (error); if (resilient) goto recover; return nullptr; } while (0)
+#define PARSE_ERROR(error) RECOVERABLE_ERROR((ParserError{ (error), currentToken }))
+#define FATAL_PARSE_ERROR(error) do { latestParserError = { (error), currentToken }; return nullptr; } while (0)
 
 	// This somewhat elephantine function is responsible for constructing the parse tree from the lexer output.
 	AstNode* Parser::parse() {
+		SSV_TRACE_SCOPE("Parser::parse");
+		QElapsedTimer parseTimer;
+		if (statistics) parseTimer.start();
+		const qint64 lexTimeBefore = statistics ? statistics->time(LoadStatistics::Lex) : 0;
+		errors.clear();
 		try {
 			lex();  // Initially fill token queue
 		} catch (const ParserError &e) {
 			latestParserError = e;
-			return nullptr;
+			if (!resilient) return nullptr;
+			errors.push_back(e);  // the tokens before the offending one have been queued all the same
 		}
 		// Create a root node that will encompass the entire file.
 		AstNode *root = createNode();
+		treeRoot = root;
 		root->type = NT_COMPOUND;
-		strcpy(root->myName, "tree_root");
+		root->myName = "tree_root";
 		std::stack<AstNode *> things;  // Explicitly use a stack instead of using recursion.
 		things.push(root);
 		State state = State::CompoundRoot;
-		Token currentToken = {0, 0, TT_NONE, {{'\0'}}};
+		Token currentToken = {0, 0, TT_NONE, {nullptr}};
+		Token entryName = currentToken;  // the name of the current top-level entry, for lazy nodes
 
-		while ((!lexerDone || !lexQueue.empty()) && !shouldCancel) {
+		while ((!lexerDone || !lexQueue.empty()) && !shouldCancel && !overBudget) {
 			try {
 				currentToken = getNextToken();
 			} catch (const ParserError &e) {
 				if (lexerDone) break;  // in case the first token the lexer encounters is EOF
-				latestParserError = e;
-				return nullptr;
+				RECOVERABLE_ERROR(e);
 			}
 			switch (state) {
 			case State::CompoundRoot:
 				if (currentToken.type == TT_STRING) {
+					const bool isSection = things.size() == 1 && !sectionFilter.isEmpty();
+					if (isSection && !sectionFilter.contains(QByteArray::fromRawData(currentToken.tok.String,
+							static_cast<int>(strlen(currentToken.tok.String))))) {
+						try {
+							skipValue();
+						} catch (const ParserError &e) {
+							RECOVERABLE_ERROR(e);
+						}
+						break;
+					}
+					if (isSection) {
+						// Start the section on a block of its own, and end the previous one there.
+						if (!sections.empty()) sections.back().endBlock = nodeStorageBlocks.size();
+						nextNodeToUse = nullptr;
+					}
 					state = State::HaveName;
+					if (things.size() == 1) entryName = currentToken;
 					AstNode *nextNode = createNode();
-					memcpy(nextNode->myName, currentToken.tok.String, 64);
+					if (isSection) sections.push_back({ nextNode, nodeStorageBlocks.size() - 1, 0, {} });
+					nextNode->myName = currentToken.tok.String;
 					ADD_AS_CHILD(nextNode);
 					things.push(nextNode);
 				} else if (currentToken.type == TT_INT) {
 					state = State::HaveName;
+					if (things.size() == 1) entryName = currentToken;
 					AstNode *nextNode = createNode();
-					QString tmp = QString::number(currentToken.tok.Int);
-					strcpy(nextNode->myName, tmp.toUtf8().data());
+					setIntKey(nextNode, currentToken.tok.Int, strings);
 					ADD_AS_CHILD(nextNode);
 					things.push(nextNode);
 				} else if (currentToken.type == TT_CBRACE) {
@@ -387,23 +678,36 @@ else { things.top()->val.firstChild = (node); things.top()->val.lastChild = (nod
 					* act as if the equals sign was present, making `intel' a compound list.
 					*/
 					// (But only if our grandparent node is indeed called `intel' or `federation_intel'.)
-					AstNode *tmpSelf = things.top();
-					things.pop();
-					AstNode *tmpParent = things.top();
-					things.pop();
-					if (strncmp(things.top()->myName, "intel", 64) == 0 ||
-						strncmp(things.top()->myName, "federation_intel", 64) == 0) {  // hack applies
+					bool hackApplies = false;
+					if (things.size() >= 3) {
+						AstNode *tmpSelf = things.top();
+						things.pop();
+						AstNode *tmpParent = things.top();
+						things.pop();
+						hackApplies = strcmp(things.top()->myName, "intel") == 0 ||
+							strcmp(things.top()->myName, "federation_intel") == 0;
 						things.push(tmpParent);
 						things.push(tmpSelf);
-						// act as if we'd read an equals sign as well.
-						state = State::HaveNameOpen;
 					}
+					// act as if we'd read an equals sign as well.
+					if (hackApplies) state = State::HaveNameOpen;
+					else PARSE_ERROR(PE_INVALID_AFTER_NAME);
 				}
 				else PARSE_ERROR(PE_INVALID_AFTER_NAME);
 				break;
 			case State::HaveNameEquals:  // Having read a name immediately followed by an equals sign
 				switch (currentToken.type) {
 				case TT_OBRACE:  // Could be compound or list
+					if (lazy && things.size() == 2) {
+						try {
+							deferValue(things.top(), currentToken, entryName.offset, entryName.line);
+						} catch (const ParserError &e) {
+							RECOVERABLE_ERROR(e);
+						}
+						things.pop();
+						state = State::CompoundRoot;
+						break;
+					}
 					state = State::HaveNameOpen;
 					break;
 				case TT_INT:  // something simple like "stuff = 30"
@@ -431,7 +735,7 @@ else { things.top()->val.firstChild = (node); things.top()->val.lastChild = (nod
 				case TT_STRING:
 					state = State::CompoundRoot;
 					things.top()->type = NT_STRING;
-					memcpy(things.top()->val.Str, currentToken.tok.String, 64);
+					things.top()->val.Str = currentToken.tok.String;
 					// again, kinda redundant, but...
 					things.top()->relation = RT_EQ;
 					things.pop();
@@ -509,15 +813,14 @@ else { things.top()->val.firstChild = (node); things.top()->val.lastChild = (nod
 					try {  // compound or string list
 						nextType = lookahead(1);
 					} catch (const ParserError &e) {
-						latestParserError = e;
-						return nullptr;
+						RECOVERABLE_ERROR(e);
 					}
 					if (nextType == TT_EQUALS || nextType == TT_GT || nextType == TT_LT) {
 						things.top()->type = NT_COMPOUND;
 						AstNode *nextNode = createNode();
 						nextNode->type = NT_INDETERMINATE;
 						state = State::HaveName;
-						memcpy(nextNode->myName, currentToken.tok.String, 64);
+						nextNode->myName = currentToken.tok.String;
 						ADD_AS_CHILD(nextNode);
 						things.push(nextNode);
 					} else if (lookahead(1) == TT_STRING || lookahead(1) == TT_CBRACE) {
@@ -525,7 +828,7 @@ else { things.top()->val.firstChild = (node); things.top()->val.lastChild = (nod
 						things.top()->type = NT_STRINGLIST;
 						AstNode *member = createNode();
 						member->type = NT_STRINGLIST_MEMBER;
-						memcpy(member->val.Str, currentToken.tok.String, 64);
+						member->val.Str = currentToken.tok.String;
 						ADD_AS_CHILD(member);
 					} else PARSE_ERROR(PE_INVALID_COMBO_AFTER_OPEN);
 					break;
@@ -543,14 +846,12 @@ else { things.top()->val.firstChild = (node); things.top()->val.lastChild = (nod
 							AstNode *nextNode = createNode();
 							nextNode->type = NT_INDETERMINATE;
 							state = State::HaveName;
-							QString tmp = QString::number(currentToken.tok.Int);
-							strcpy(nextNode->myName, tmp.toUtf8().data());
+							setIntKey(nextNode, currentToken.tok.Int, strings);
 							ADD_AS_CHILD(nextNode);
 							things.push(nextNode);
 						} else PARSE_ERROR(PE_INVALID_COMBO_AFTER_OPEN);
 					} catch (const ParserError &e) {
-						latestParserError = e;
-						return nullptr;
+						RECOVERABLE_ERROR(e);
 					}
 					break;
 				case TT_DOUBLE: {
@@ -644,7 +945,7 @@ else { things.top()->val.firstChild = (node); things.top()->val.lastChild = (nod
 				if (currentToken.type == TT_STRING) {
 					AstNode *member = createNode();
 					member->type = NT_STRINGLIST_MEMBER;
-					memcpy(member->val.Str, currentToken.tok.String, 64);
+					member->val.Str = currentToken.tok.String;
 					ADD_AS_CHILD(member);
 				} else if (currentToken.type == TT_CBRACE) {
 					state = State::CompoundRoot;
@@ -666,15 +967,63 @@ else { things.top()->val.firstChild = (node); things.top()->val.lastChild = (nod
 			if (things.empty()) {  // an extraneous closing brace caused our implicit root node to be closed
 				PARSE_ERROR(PE_TOO_MANY_CLOSE_BRACES);
 			}
+			continue;
+
+		recover:
+			// Resynchronize at the next brace depth boundary: give up on the innermost node that
+			// the error occurred in, make it empty and continue after its end.
+			errors.push_back(latestParserError);
+			try {
+				const Token bad = latestParserError.erroredToken;
+				if (things.empty()) {  // a closing brace too many: ignore it
+					things.push(root);
+					state = State::CompoundRoot;
+				} else if (state == State::CompoundRoot) {  // a stray token: skip it, and its block if it opens one
+					if (bad.type == TT_OBRACE) skipToClose(1);
+				} else if (state >= State::HaveName && state <= State::HaveNameLtEq) {  // a name without a value
+					makeEmpty(things.top());
+					things.pop();
+					state = State::CompoundRoot;
+					if (bad.type == TT_OBRACE) skipToClose(1);
+					else if (bad.type == TT_CBRACE) lexQueue.prepend(bad);  // closes the parent
+				} else {  // within a list, or right after its opening brace
+					makeEmpty(things.top());
+					things.pop();
+					skipToClose(bad.type == TT_OBRACE ? 2 : 1);
+					state = things.top()->type == NT_COMPOUNDLIST ? State::BegunCompoundList : State::CompoundRoot;
+				}
+			} catch (const ParserError &e) {  // the input ended while skipping
+				latestParserError = e;
+				errors.push_back(e);
+				break;
+			}
 		}
 
+		if (!sections.empty()) sections.back().endBlock = nodeStorageBlocks.size();
+		if (overBudget) FATAL_PARSE_ERROR(PE_MEMORY_BUDGET_EXCEEDED);
 		// Bail out if user cancelled.
-		if (shouldCancel) PARSE_ERROR(PE_CANCELLED);
+		if (shouldCancel) FATAL_PARSE_ERROR(PE_CANCELLED);
 		// alternatively, if all input is consumed but the parser isn't "at rest"...
 		if (things.size() > 1 || state != State::CompoundRoot) {
-			PARSE_ERROR(PE_UNEXPECTED_END);
+			if (!resilient) FATAL_PARSE_ERROR(PE_UNEXPECTED_END);
+			// Keep what has been read of the unfinished nodes.
+			if (errors.empty() || errors.back().etype != PE_UNEXPECTED_END) {
+				latestParserError = { PE_UNEXPECTED_END, currentToken };
+				errors.push_back(latestParserError);
+			}
+			for (; things.size() > 1; things.pop()) {
+				if (things.top()->type == NT_INDETERMINATE) makeEmpty(things.top());
+			}
 		}
 
+		if (statistics) {
+			// lex() is called from within the parser and has been timed on its own.
+			const qint64 lexTime = statistics->time(LoadStatistics::Lex) - lexTimeBefore;
+			statistics->addTime(LoadStatistics::Parse, parseTimer.nsecsElapsed() - lexTime);
+			statistics->add(LoadStatistics::Tokens, tokensLexed);
+			statistics->add(LoadStatistics::Nodes, nodesCreated);
+			statistics->add(LoadStatistics::ArenaBlocks, nodeStorageBlocks.size());
+		}
 		return root;
 	}
 
@@ -684,11 +1033,29 @@ else { things.top()->val.firstChild = (node); things.top()->val.lastChild = (nod
 		shouldCancel = true;
 	}
 
+	void Parser::setStatistics(LoadStatistics *statistics) {
+		this->statistics = statistics;
+	}
+
 	// Gets the stored parser error.
 	ParserError Parser::getLatestParserError() const {
 		return latestParserError;
 	}
 
+	qint64 Parser::lexAll() {
+		qint64 tokens = 0;
+		try {
+			while (!lexerDone && !shouldCancel) {
+				tokens += lex();
+				lexQueue.clear();
+			}
+		} catch (const ParserError &e) {
+			latestParserError = e;
+			return -1;
+		}
+		return tokens;
+	}
+
 	// Gets the next token from the queue, calling the lexer if necessary.
 	// Throws an "unexpected end" parser error if at end of file.
 	Token Parser::getNextToken() {
@@ -697,33 +1064,26 @@ else { things.top()->val.firstChild = (node); things.top()->val.lastChild = (nod
 			everyNth(lexCalls1, 100, emit progress(this, totalProgress, totalSize));
 		}
 		if (lexQueue.isEmpty()) {
-			throw ParserError{ PE_UNEXPECTED_END, {line, charPos, TT_NONE, {{0}}} };
+			throw ParserError{ PE_UNEXPECTED_END, {line, charPos, TT_NONE, {nullptr}} };
 		}
 		return lexQueue.dequeue();
 	}
 
-#ifdef Q_OS_MAC
-#define LEXER_SETUP(locale) const auto locale = setlocale(LC_NUMERIC, nullptr); setlocale(LC_NUMERIC, "C")
-#define LEXER_TEARDOWN(locale) setlocale(LC_NUMERIC, (locale))
-#else
-#define LEXER_SETUP(locale)
-#define LEXER_TEARDOWN(locale)
-#endif
-
 	// Lex into the queue. Attempt to provide `atLeast' many tokens: can be more if the last
 	// token ends in a special character, can be less if end of file is reached.
 	// Returns the number of tokens lexed.
 	int Parser::lex(int atLeast) {
 		if (atLeast == 0) atLeast = queueCapacity;
-		char buf[64];
 		char c;
 		TokenType assumption = TT_NONE;
 		int tokensRead = 0;
-		unsigned int len = 0;
+		size_t tokenStart = 0;
+		tokenText.clear();
 		bool haveOpenQuote = false;
 		bool comment = false;
 		bool haveEscape = false;
-		LEXER_SETUP(oldLocale);
+		ScopedTimer timer(statistics, LoadStatistics::Lex);
+		SSV_TRACE_SCOPE("Parser::lex");
 
 		while (!data.eof() && tokensRead < atLeast && lexQueue.count() < queueCapacity-1) {
 			c = data.getc();
@@ -747,10 +1107,7 @@ else { things.top()->val.firstChild = (node); things.top()->val.lastChild = (nod
 					if (!haveEscape) {
 						haveEscape = (c == '\\');
 					} else {
-						if ((c == '"' || c == '\\') && len < 63) {
-							buf[len] = c;
-							buf[++len] = '\0';
-						}
+						if (c == '"' || c == '\\') tokenText += c;
 						haveEscape = false;
 						continue;
 					}
@@ -762,64 +1119,60 @@ else { things.top()->val.firstChild = (node); things.top()->val.lastChild = (nod
 					}
 					else {  // This begins a quoted string
 						haveOpenQuote = true;
+						if (assumption == TT_NONE) tokenStart = data.tell() - 1;
 						assumption = TT_STRING;
 						continue;  // Don't add the quotation mark to the result
 					}
 				}
-				if (len < 63) {
-					buf[len] = c;
-					buf[++len] = '\0';
-
-					// update our assumption of what the currently-read token is, if necessary.
-					if (assumption == TT_NONE) {
-						if (isdigit(c) || c == '-') assumption = TT_INT;
-						else assumption = TT_STRING;
-					} else if (assumption == TT_INT && c == '.') {
-						assumption = TT_DOUBLE;
-					} else if (assumption == TT_DOUBLE && c == '.') {
-						// most likely a date, but we don't really use those so we treat it as a string.
-						assumption = TT_STRING;
-					}
+				tokenText += c;
+
+				// update our assumption of what the currently-read token is, if necessary.
+				if (assumption == TT_NONE) {
+					tokenStart = data.tell() - 1;
+					if (isdigit(c) || c == '-') assumption = TT_INT;
+					else assumption = TT_STRING;
+				} else if (assumption == TT_INT && c == '.') {
+					assumption = TT_DOUBLE;
+				} else if (assumption == TT_DOUBLE && c == '.') {
+					// most likely a date, but we don't really use those so we treat it as a string.
+					assumption = TT_STRING;
 				}
 			} else { finish_off_token:
 				Token token{};
 				token.line = line;
-				token.firstChar = charPos - len;
-				char *eptr;
+				token.firstChar = charPos - tokenText.size();
+				token.offset = tokenStart;
+				const char *text = tokenText.data();
+				const char *textEnd = text + tokenText.size();
 				switch (assumption) {
 				case TT_STRING:
 					// Check if our "string" might be a bool after all
-					if (strcmp(buf, "yes") == 0 || strcmp(buf, "YES") == 0) {
-						token.type = TT_BOOL;
-						token.tok.Bool = true;
-					}
-					else if (strcmp(buf, "no") == 0 || strcmp(buf, "NO") == 0) {
+					if (auto boolValue = boolLiterals.find(std::string_view(tokenText))) {
 						token.type = TT_BOOL;
-						token.tok.Bool = false;
+						token.tok.Bool = *boolValue;
 					} else {  // nope, it really is a string
 						token.type = TT_STRING;
-						// string length is currently limited to 64 bytes
-						memcpy(token.tok.String, buf, 64);
+						token.tok.String = strings->intern(tokenText);
 					}
 					break;
 				case TT_INT:
 					token.type = TT_INT;
-					token.tok.Int = strtoll(buf, &eptr, 10);
-					if (Q_UNLIKELY(token.tok.Int == 0 && eptr == buf)) {
+					if (Q_UNLIKELY(parseInt(text, textEnd, &token.tok.Int) == text)) {
 						token.type = TT_NONE;
-						memcpy(token.tok.String, buf, 64);
-						LEXER_TEARDOWN(oldLocale);
-						throw ParserError{ LE_INVALID_INT, token };
+						token.tok.String = strings->intern(tokenText);
+						if (!resilient) throw ParserError{ LE_INVALID_INT, token };
+						errors.push_back({ LE_INVALID_INT, token });
+						token.type = TT_STRING;  // keep it as it is
 					}
 					break;
 				case TT_DOUBLE:
 					token.type = TT_DOUBLE;
-					token.tok.Double = strtod(buf, &eptr);
-					if (Q_UNLIKELY(eptr == buf)) {
+					if (Q_UNLIKELY(parseDouble(text, textEnd, &token.tok.Double) == text)) {
 						token.type = TT_NONE;
-						memcpy(token.tok.String, buf, 64);
-						LEXER_TEARDOWN(oldLocale);
-						throw ParserError{ LE_INVALID_DOUBLE, token };
+						token.tok.String = strings->intern(tokenText);
+						if (!resilient) throw ParserError{ LE_INVALID_DOUBLE, token };
+						errors.push_back({ LE_INVALID_DOUBLE, token });
+						token.type = TT_STRING;  // keep it as it is
 					}
 					break;
 				case TT_NONE:  // Special character
@@ -853,13 +1206,15 @@ else { things.top()->val.firstChild = (node); things.top()->val.lastChild = (nod
 					Token stok{};
 					stok.line = line;
 					stok.firstChar = charPos;
+					stok.offset = data.tell() - 1;
 					stok.type = specialType;
 					lexQueue.append(stok);
 					tokensRead++;
 				}
 				assumption = TT_NONE;
-				buf[0] = '\0';
-				len = 0;
+				tokenText.clear();
+				// The value that begins here may be deferred, and then nothing after it must have been lexed.
+				if (lazy && specialType == TT_OBRACE) break;
 			}
 			if (c == '\n') {
 				line++;
@@ -871,14 +1226,14 @@ else { things.top()->val.firstChild = (node); things.top()->val.lastChild = (nod
 			lexerDone = true;
 			// produce an error if the file ended in the middle of a token.
 			if (assumption != TT_NONE) {
-				Token currentToken{ line, charPos - len, TT_NONE, {{0}} };
-				memcpy(currentToken.tok.String, buf, 64);
-				LEXER_TEARDOWN(oldLocale);
+				Token currentToken{ line, charPos - tokenText.size(), TT_NONE, {nullptr} };
+				currentToken.tok.String = strings->intern(tokenText);
 				throw ParserError{PE_UNEXPECTED_END, currentToken};
 			}
 		}
 		totalProgress = data.tell();
-		LEXER_TEARDOWN(oldLocale);
+		data.releaseReadInput();
+		tokensLexed += tokensRead;
 		return tokensRead;
 	}
 
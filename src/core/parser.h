@@ -21,13 +21,19 @@
 #define STELLARIS_STAT_VIEWER_PARSER_H
 
 #include <stdint.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
 #include <vector>
 
 #include <QtCore/QFileInfo>
 #include <QtCore/QObject>
 #include <QtCore/QQueue>
+#include <QtCore/QSet>
 #include <QtCore/QString>
 class QFile;
+class LoadStatistics;
 
 namespace Parsing {
 	// Indicates the type of a lexed token.
@@ -55,11 +61,13 @@ namespace Parsing {
 		// Potential values of this token. The active element is indicated by the `type'.
 		// (Not all TokenTypes have a value.)
 		union {
-			char String[64];
+			const char *String;  // owned by the parser's StringPool
 			bool Bool;
 			int64_t Int;
 			double Double;
 		} tok;
+		// the byte offset in the file at which this token begun
+		uint64_t offset = 0;
 	};
 	
 	// indicates the type of file being read
@@ -88,7 +96,8 @@ namespace Parsing {
 		NT_STRINGLIST_MEMBER,  // a single element within a list of strings
 		NT_BOOLLIST,  // a list of booleans, e.g. test = { yes no yes }
 		NT_BOOLLIST_MEMBER,  // a single member within a list of strings
-		NT_EMPTY  // an empty node, e.g. test = {} -- the exact type (compund, int list, etc.) can't be determined.
+		NT_EMPTY,  // an empty node, e.g. test = {} -- the exact type (compund, int list, etc.) can't be determined.
+		NT_LAZY  // a top-level compound or list that has not been parsed yet (see Parser::setLazy())
 	};
 
 	// The relation within and int or double node: =, >, <, >=, <=
@@ -101,6 +110,33 @@ namespace Parsing {
 		RT_LE
 	};
 
+	class Parser;
+
+	/** Storage for the names and string values in a parse tree, of any length.
+	 *
+	 * Every distinct string is kept once, so the few hundred names that make up most of a save file
+	 * take up no space per node beyond a pointer. Strings are freed together with the pool only.
+	 */
+	class StringPool {
+		Q_DISABLE_COPY(StringPool)
+	public:
+		StringPool() = default;
+		/** A nul-terminated copy of `str', the same one for equal strings. */
+		const char *intern(std::string_view str);
+		/** Approximately how many bytes the pool takes up. */
+		size_t memoryUsage() const;
+
+	private:
+		char *allocate(size_t size);
+
+		static constexpr size_t blockSize = 64 * 1024;
+		std::vector<std::unique_ptr<char[]>> blocks;
+		char *nextFree = nullptr;
+		size_t bytesLeft = 0;
+		size_t bytesAllocated = 0;
+		std::unordered_set<std::string_view> strings;
+	};
+
 	// Represents a node in the parse tree.
 	struct AstNode {
 		/** Merge 'other' into this tree
@@ -120,19 +156,26 @@ namespace Parsing {
 		 */
 		AstNode *findChildWithName(const char *name) const;
 		int64_t countChildren() const;
+		/** If this node has not been parsed yet (NT_LAZY), parse it now. Both of the above do this
+		 *  for the nodes they look at, so this is only needed for iterating over children directly. */
+		void expand();
 
-		// the name of this node.
-		char myName[64] = {'\0'};
+		// the name of this node (owned by the parser's StringPool).
+		const char *myName = "";
+		// If the name is an integer (such as the ids of countries, fleets, ships, ...), its value.
+		int64_t intKey = 0;
 		// The type of this node
 		NodeType type = NT_INDETERMINATE;
+		// Whether the name is an integer, see intKey.
+		bool keyIsInt = false;
 		// The next sibling of this node.
 		AstNode *nextSibling = nullptr;
 		// The relation type in this node (see above).
 		RelationType relation = RT_NONE;
 		// The value of this node. The active union member is indicated by the NodeType.
 		union NodeValue {
-			// for string nodes
-			char Str[64];
+			// for string nodes (owned by the parser's StringPool)
+			const char *Str;
 			// for boolean nodes
 			bool Bool;
 			// for integer nodes
@@ -141,7 +184,9 @@ namespace Parsing {
 			double Double;
 			// for compound and list nodes.
 			struct { AstNode *firstChild; AstNode *lastChild; };
-		} val = {{'\0'}};
+			// for lazy nodes: where in the file the whole entry, name included, is to be found.
+			struct { Parser *owner; uint64_t begin; uint64_t end; uint64_t line; } lazy;
+		} val = {nullptr};
 	};
 
 	/** For debugging purposes, print the parse tree. */
@@ -165,7 +210,8 @@ namespace Parsing {
 		PE_TOO_MANY_CLOSE_BRACES,
 		LE_INVALID_INT,
 		LE_INVALID_DOUBLE,
-		PE_CANCELLED
+		PE_CANCELLED,
+		PE_MEMORY_BUDGET_EXCEEDED
 	};
 
 	/** Get a textual representation of the given error type. */
@@ -174,14 +220,18 @@ namespace Parsing {
 	/** Represents a parser error, consisting of a type and the token causing the error. */
 	struct ParserError {
 		ParseErr etype;
-		Token erroredToken;
+		Token erroredToken;  // its string, if any, only lives as long as the parser
 	};
 
 	/** A memory buffer for reading files, with an interface modeled after stdio.h */
 	class MemBuf {
 		Q_DISABLE_COPY(MemBuf)
 	public:
-		MemBuf(char *area, size_t size);
+		enum Ownership {
+			TakeOwnership,  // free() the area when done
+			Borrow  // the area belongs to someone else and must outlive the MemBuf
+		};
+		MemBuf(char *area, size_t size, Ownership ownership = TakeOwnership);
 		explicit MemBuf(const QByteArray &arr);
 		explicit MemBuf(QFile &file);
 		~MemBuf();
@@ -195,8 +245,9 @@ namespace Parsing {
 		inline bool eof() {
 			return location == _size;
 		}
-		/** Go back to the beginning of the buffer */
+		/** Go back to the beginning of the buffer. Not possible once input has been released. */
 		inline void rewind() {
+			Q_ASSERT(released == 0);
 			location = 0;
 		}
 		/** Get the current position in the buffer */
@@ -207,10 +258,38 @@ namespace Parsing {
 		inline size_t size() {
 			return _size;
 		}
+		/** Continue reading at `position'. */
+		inline void seek(size_t position) {
+			Q_ASSERT(position >= released && position <= _size);
+			location = position;
+		}
+		/** The whole buffer */
+		inline char *data() {
+			return buf;
+		}
+		/** Whether to hand pages that have been read back to the operating system as reading goes on,
+		 *  so that only the unread part of the buffer takes up memory. Their content is lost. */
+		inline void setReleaseInput(bool release) {
+			releaseInput = release;
+		}
+		/** Release what has been read so far, if enabled and enough to be worth a system call. */
+		inline void releaseReadInput() {
+			if (Q_UNLIKELY(releaseInput) && location - released >= releaseChunk) releasePages();
+		}
+		/** How much of the buffer still takes up memory. */
+		inline size_t residentSize() {
+			return _size - released;
+		}
 	private:
+		void releasePages();
+
+		static constexpr size_t releaseChunk = 4 << 20;
 		char *buf;
 		size_t location;
 		size_t _size;
+		size_t released = 0;
+		bool releaseInput = false;
+		bool owned = true;
 	};
 
 	/** Where parsing and lexing take place. */
@@ -221,10 +300,38 @@ namespace Parsing {
 		~Parser();
 		/** Parse the file and return a pointer to the root node */
 		AstNode *parse();
+		/** Only run the lexer over the whole file, throwing the tokens away. Returns the number of
+		 *  tokens, or -1 on error (see getLatestParserError()). Meant for benchmarking. */
+		qint64 lexAll();
 		/** Cancel parsing at the next possible occasion */
 		void cancel();
+		/** Record lexing and parsing times, tokens, nodes and node blocks in `statistics' (may be nullptr). */
+		void setStatistics(LoadStatistics *statistics);
+		/** Only build nodes for the top-level entries with these names and skip over all others.
+		 *  Each entry that is kept gets nodes of its own, so that it can be released separately. */
+		void setSectionFilter(const QSet<QByteArray> &sections);
+		/** Fail with PE_MEMORY_BUDGET_EXCEEDED once the parse tree and the unread input together take up
+		 *  more than `bytes'. Negative for no limit, the default. */
+		void setMemoryBudget(qint64 bytes);
+		/** Bytes currently taken up by the parse tree and the unread input. */
+		qint64 memoryInUse() const;
+		/** Free a top-level entry of the tree returned by parse(), and all nodes below it, and remove it
+		 *  from the tree. Only possible with a section filter; returns false for anything else. */
+		bool releaseSection(const AstNode *section);
+		/** Don't parse the values of top-level compounds and lists right away, only find where they end.
+		 *  They become NT_LAZY nodes that are parsed when first looked at (see AstNode::expand()), so
+		 *  the input must be kept around, unreleased, until the tree is no longer needed. Errors within
+		 *  them are only found then, and leave them empty; see getLatestParserError(). So does exceeding
+		 *  the memory budget while expanding them, after which nothing more is expanded. */
+		void setLazy(bool lazy);
+		/** Don't give up at the first error, but record it, make the compound or list that it occurred in
+		 *  empty (NT_EMPTY), continue after the end of that and return what could be read. Only cancelling
+		 *  and exceeding the memory budget still make parse() fail. */
+		void setResilient(bool resilient);
 		/** Get the stored parser error */
 		ParserError getLatestParserError() const;
+		/** All errors that parse() recovered from in resilient mode, in the order they were found */
+		const std::vector<ParserError> &getErrors() const;
 
 	signals:
 		/** Emitted periodically to indicate the current parse progress. */
@@ -235,6 +342,11 @@ namespace Parsing {
 		int lex(int atLeast = 0);
 		TokenType lookahead(int n);
 		AstNode *createNode();
+		void skipValue();
+		void skipToClose(int depth);
+		static void makeEmpty(AstNode *node);
+		void deferValue(AstNode *node, const Token &open, uint64_t nameOffset, uint64_t nameLine);
+		void materialize(AstNode *node);
 
 		static void fixListType(AstNode *list);
 
@@ -256,9 +368,34 @@ namespace Parsing {
 		unsigned long line = 1;
 		unsigned long charPos = 0;
 
-		ParserError latestParserError{PE_NONE, {0, 0, TT_NONE, {{0}}}};
+		ParserError latestParserError{PE_NONE, {0, 0, TT_NONE, {nullptr}}};
+		StringPool ownStrings;
+		StringPool *strings = &ownStrings;  // shared with the parsers that expand lazy nodes
+		std::string tokenText;  // the text of the token being lexed
 
 		unsigned int lexCalls1 = 1;
+		LoadStatistics *statistics = nullptr;
+		qint64 tokensLexed = 0;
+		qint64 nodesCreated = 0;
+
+		// A top-level entry kept by the section filter and the blocks of nodes that belong to it.
+		struct Section {
+			const AstNode *node;
+			size_t firstBlock;
+			size_t endBlock;
+			std::vector<size_t> lazyBlocks;  // added when the entry was expanded
+		};
+		QSet<QByteArray> sectionFilter;
+		std::vector<Section> sections;
+		AstNode *treeRoot = nullptr;
+		size_t liveBlocks = 0;
+		qint64 memoryBudget = -1;
+		bool overBudget = false;
+		bool lazy = false;
+		bool resilient = false;
+		std::vector<ParserError> errors;
+
+		friend struct AstNode;
 	};
 }
 
@@ -47,7 +47,7 @@ namespace Galaxy {
 
 	Ship *Ship::createFromAst(const AstNode *tree, State *parent) {
 		Ship *state = new Ship(parent);
-		state->index = static_cast<qint64>(QString(tree->myName).toLongLong());
+		state->index = tree->intKey;
 		
 		AstNode *fleetNode = tree->findChildWithName("fleet");
 		CHECK_PTR(fleetNode);
@@ -68,9 +68,6 @@ namespace Galaxy {
 		}
 		state->design = parent->getShipDesigns().value(designNode->val.Int);
 		CHECK_PTR(state->design);
-		if (state->design->getSize() <= ShipSize::StarbaseCitadel) {  // this is a starbase of some description, implying system ownership
-			state->fleet->getOwner()->ownedSystems += 1;
-		}
 
 		return state;
 	}
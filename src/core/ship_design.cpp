@@ -18,43 +18,44 @@
 #include "ship_design.h"
 
 #include "galaxy_state.h"
+#include "keyword_table.h"
 #include "model_private_macros.h"
 #include "parser.h"
 
 using Parsing::AstNode;
 
 namespace Galaxy {
-	const QMap<QString, ShipSize> ShipDesign::shipSizes = {
-			{ "starbase_outpost", ShipSize::StarbaseOutpost },
-			{ "starbase_starport", ShipSize::StarbaseStarport },
-			{ "starbase_citadel", ShipSize::StarbaseCitadel },
-			{ "starbase_starhold", ShipSize::StarbaseStarhold },
-			{ "starbase_starfortress", ShipSize::StarbaseStarfortress },
-			{ "military_station_small", ShipSize::DefensePlatSmall },
-			{ "military_station_medium", ShipSize::DefensePlatMedium },
-			{ "military_station_large", ShipSize::DefensePlatLarge },
-			{ "ion_cannon", ShipSize::IonCannon },
-			{ "military_station_small_fallen_empire", ShipSize::FallenSmallStation },
-			{ "military_station_large_fallen_empire", ShipSize::FallenLargeStation },      // speculation
-			{ "military_station_massive_fallen_empire", ShipSize::FallenMassiveStation },  // speculation
-			{ "mining_station", ShipSize::MiningStation },
-			{ "research_station", ShipSize::ResearchStation },
-			{ "observation_station", ShipSize::ObservationStation },
-			{ "corvette", ShipSize::Corvette },
-			{ "destroyer", ShipSize::Destroyer },
-			{ "cruiser", ShipSize::Cruiser },
-			{ "battleship", ShipSize::Battleship },
-			{ "titan", ShipSize::Titan },
-			{ "colossus", ShipSize::Colossus },
-			{ "transport", ShipSize::TransportShip },
-			{ "small_ship_fallen_empire", ShipSize::FallenSmallShip },
-			{ "large_ship_fallen_empire", ShipSize::FallenLargeShip },
-			{ "massive_ship_fallen_empire", ShipSize::FallenMassiveShip },
-			{ "constructor", ShipSize::ConstructionShip },
-			{ "science", ShipSize::ScienceShip },
-			{ "colonizer", ShipSize::ColonyShip },
-			{ "sponsored_colonizer", ShipSize::ColonyShipPrivate }
-	};
+	static constexpr Parsing::KeywordTable<ShipSize, 29> shipSizes({{
+		{ "starbase_outpost", ShipSize::StarbaseOutpost },
+		{ "starbase_starport", ShipSize::StarbaseStarport },
+		{ "starbase_citadel", ShipSize::StarbaseCitadel },
+		{ "starbase_starhold", ShipSize::StarbaseStarhold },
+		{ "starbase_starfortress", ShipSize::StarbaseStarfortress },
+		{ "military_station_small", ShipSize::DefensePlatSmall },
+		{ "military_station_medium", ShipSize::DefensePlatMedium },
+		{ "military_station_large", ShipSize::DefensePlatLarge },
+		{ "ion_cannon", ShipSize::IonCannon },
+		{ "military_station_small_fallen_empire", ShipSize::FallenSmallStation },
+		{ "military_station_large_fallen_empire", ShipSize::FallenLargeStation },      // speculation
+		{ "military_station_massive_fallen_empire", ShipSize::FallenMassiveStation },  // speculation
+		{ "mining_station", ShipSize::MiningStation },
+		{ "research_station", ShipSize::ResearchStation },
+		{ "observation_station", ShipSize::ObservationStation },
+		{ "corvette", ShipSize::Corvette },
+		{ "destroyer", ShipSize::Destroyer },
+		{ "cruiser", ShipSize::Cruiser },
+		{ "battleship", ShipSize::Battleship },
+		{ "titan", ShipSize::Titan },
+		{ "colossus", ShipSize::Colossus },
+		{ "transport", ShipSize::TransportShip },
+		{ "small_ship_fallen_empire", ShipSize::FallenSmallShip },
+		{ "large_ship_fallen_empire", ShipSize::FallenLargeShip },
+		{ "massive_ship_fallen_empire", ShipSize::FallenMassiveShip },
+		{ "constructor", ShipSize::ConstructionShip },
+		{ "science", ShipSize::ScienceShip },
+		{ "colonizer", ShipSize::ColonyShip },
+		{ "sponsored_colonizer", ShipSize::ColonyShipPrivate }
+	}});
 
 	ShipDesign::ShipDesign(QObject *parent) : QObject(parent) {}
 
@@ -76,7 +77,7 @@ namespace Galaxy {
 
 	ShipDesign *ShipDesign::createFromAst(const AstNode *tree, Galaxy::State *parent) {
 		ShipDesign *state = new ShipDesign(parent);
-		state->index = static_cast<qint64>(QString(tree->myName).toLongLong());
+		state->index = tree->intKey;
 
 		AstNode *nameNode = tree->findChildWithName("name");
 		AstNode *sizeNode;
@@ -75,7 +75,6 @@ namespace Galaxy {
 		QString name;
 		ShipSize size;
 		bool isAutogen;
-		static const QMap<QString, ShipSize> shipSizes;
 	};
 }
 
@@ -0,0 +1,173 @@
+/* core/techgraph.cpp: The technologies and their prerequisites, compiled for fast queries
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "techgraph.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "galaxy_model.h"
+#include "technology.h"
+
+namespace Galaxy {
+	TechGraph::TechGraph(const Model &model) {
+		const QMap<QString, Technology *> &all = model.getTechnologies();
+		techs.reserve(all.size());
+		for (auto it = all.cbegin(); it != all.cend(); it++) {
+			ids.insert(it.key(), techs.size());
+			techs.append(it.value());
+		}
+		const int count = techs.size();
+
+		// Build both directions from the same list of edges, dropping unknown technologies and duplicates.
+		QVector<int> prerequisiteCount(count, 0), dependentCount(count, 0);
+		QVector<QPair<int, int>> edges;
+		for (int id = 0; id < count; id++) {
+			const int firstEdge = edges.size();
+			for (const QString &name : techs[id]->getRequirements()) {
+				const int prerequisite = ids.value(name, -1);
+				if (prerequisite < 0 || prerequisite == id) continue;
+				const QPair<int, int> edge(prerequisite, id);
+				if (std::find(edges.cbegin() + firstEdge, edges.cend(), edge) != edges.cend()) continue;
+				edges.append(edge);
+				prerequisiteCount[id]++;
+				dependentCount[prerequisite]++;
+			}
+		}
+		prerequisiteOffsets.resize(count + 1);
+		dependentOffsets.resize(count + 1);
+		prerequisiteOffsets[0] = dependentOffsets[0] = 0;
+		for (int id = 0; id < count; id++) {
+			prerequisiteOffsets[id + 1] = prerequisiteOffsets[id] + prerequisiteCount[id];
+			dependentOffsets[id + 1] = dependentOffsets[id] + dependentCount[id];
+		}
+		prerequisiteIds.resize(edges.size());
+		dependentIds.resize(edges.size());
+		QVector<int> prerequisiteFill(prerequisiteOffsets), dependentFill(dependentOffsets);
+		for (const QPair<int, int> &edge : std::as_const(edges)) {
+			prerequisiteIds[prerequisiteFill[edge.second]++] = edge.first;
+			dependentIds[dependentFill[edge.first]++] = edge.second;
+		}
+
+		// Topological order (prerequisites first), so that each closure is the union of the closures
+		// of its neighbours. Technologies in a (broken) cycle are appended in id order; their closures
+		// are then just a best effort.
+		QVector<int> order;
+		order.reserve(count);
+		QVector<int> waitingFor(prerequisiteCount);
+		for (int id = 0; id < count; id++) if (waitingFor[id] == 0) order.append(id);
+		for (int i = 0; i < order.size(); i++) {
+			for (int dependent : dependents(order[i])) {
+				if (--waitingFor[dependent] == 0) order.append(dependent);
+			}
+		}
+		if (order.size() < count) {
+			for (int id = 0; id < count; id++) if (waitingFor[id] > 0) order.append(id);
+		}
+
+		ancestorSets.fill(DynamicBitset(count), count);
+		descendantSets.fill(DynamicBitset(count), count);
+		for (int i = 0; i < count; i++) {
+			const int id = order[i];
+			for (int prerequisite : prerequisites(id)) {
+				ancestorSets[id] |= ancestorSets[prerequisite];
+				ancestorSets[id].set(prerequisite);
+			}
+		}
+		for (int i = count - 1; i >= 0; i--) {
+			const int id = order[i];
+			for (int dependent : dependents(id)) {
+				descendantSets[id] |= descendantSets[dependent];
+				descendantSets[id].set(dependent);
+			}
+		}
+	}
+
+	int TechGraph::size() const {
+		return techs.size();
+	}
+
+	int TechGraph::idOf(const QString &name) const {
+		return ids.value(name, -1);
+	}
+
+	const Technology *TechGraph::technology(int id) const {
+		return techs[id];
+	}
+
+	DynamicBitset TechGraph::setOf(const QStringList &names) const {
+		DynamicBitset result(size());
+		for (const QString &name : names) {
+			const int id = idOf(name);
+			if (id >= 0) result.set(id);
+		}
+		return result;
+	}
+
+	TechGraph::Ids TechGraph::idsIn(const QVector<int> &offsets, const QVector<int> &targets, int id) {
+		return { targets.constData() + offsets[id], targets.constData() + offsets[id + 1] };
+	}
+
+	TechGraph::Ids TechGraph::prerequisites(int id) const {
+		return idsIn(prerequisiteOffsets, prerequisiteIds, id);
+	}
+
+	TechGraph::Ids TechGraph::dependents(int id) const {
+		return idsIn(dependentOffsets, dependentIds, id);
+	}
+
+	const DynamicBitset &TechGraph::ancestors(int id) const {
+		return ancestorSets[id];
+	}
+
+	const DynamicBitset &TechGraph::descendants(int id) const {
+		return descendantSets[id];
+	}
+
+	DynamicBitset TechGraph::researchPath(int id, const DynamicBitset &researched) const {
+		DynamicBitset result(ancestorSets[id]);
+		result.set(id);
+		return result -= researched;
+	}
+
+	DynamicBitset TechGraph::unlockedBy(int id, const DynamicBitset &researched) const {
+		DynamicBitset withTech(researched);
+		withTech.set(id);
+		DynamicBitset result(size());
+		for (int dependent : dependents(id)) {
+			if (!withTech.test(dependent) && hasPrerequisites(dependent, withTech)) result.set(dependent);
+		}
+		return result;
+	}
+
+	DynamicBitset TechGraph::frontier(const DynamicBitset &researched) const {
+		DynamicBitset result(size());
+		for (int id = 0; id < size(); id++) {
+			if (!researched.test(id) && hasPrerequisites(id, researched)) result.set(id);
+		}
+		return result;
+	}
+
+	// Like the game, only look at the direct prerequisites: technologies can be granted by other
+	// means, so an empire may well have a technology without having all of its ancestors.
+	bool TechGraph::hasPrerequisites(int id, const DynamicBitset &researched) const {
+		for (int prerequisite : prerequisites(id)) {
+			if (!researched.test(prerequisite)) return false;
+		}
+		return true;
+	}
+}
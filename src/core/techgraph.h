@@ -0,0 +1,88 @@
+/* core/techgraph.h: The technologies and their prerequisites, compiled for fast queries (header file)
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#ifndef STELLARIS_STAT_VIEWER_TECHGRAPH_H
+#define STELLARIS_STAT_VIEWER_TECHGRAPH_H
+
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+#include "dynamic_bitset.h"
+
+namespace Galaxy {
+	class Model;
+	class Technology;
+
+	/** The prerequisite relation between the technologies of a Model, with technologies numbered
+	 *  0 to size() - 1 in the order of their names. Sets of technologies are DynamicBitsets of size().
+	 *
+	 * Both directions of the relation are stored as arrays of ids (compressed sparse rows), and the
+	 * transitive closures are computed up front, so the queries below don't look up any names.
+	 * The graph refers to the model's technologies, which must outlive it.
+	 */
+	class TechGraph {
+	public:
+		/** A contiguous run of technology ids. */
+		struct Ids {
+			const int *first, *last;
+			const int *begin() const { return first; }
+			const int *end() const { return last; }
+			int size() const { return static_cast<int>(last - first); }
+		};
+
+		TechGraph() = default;
+		explicit TechGraph(const Model &model);
+
+		int size() const;
+		/** Returns -1 for unknown technologies. */
+		int idOf(const QString &name) const;
+		const Technology *technology(int id) const;
+		/** The set of the given technologies, ignoring those that are not part of the graph. */
+		DynamicBitset setOf(const QStringList &names) const;
+
+		/** Technologies that `id' directly requires. */
+		Ids prerequisites(int id) const;
+		/** Technologies that directly require `id'. */
+		Ids dependents(int id) const;
+		/** Everything that has to be researched before `id' can be. */
+		const DynamicBitset &ancestors(int id) const;
+		/** Everything that (directly or indirectly) requires `id'. */
+		const DynamicBitset &descendants(int id) const;
+
+		/** What an empire that has researched `researched' still needs to research to get `id', including `id' itself. */
+		DynamicBitset researchPath(int id, const DynamicBitset &researched) const;
+		/** Technologies that become available once `id' is researched on top of `researched'. */
+		DynamicBitset unlockedBy(int id, const DynamicBitset &researched) const;
+		/** Technologies not in `researched' whose prerequisites all are. */
+		DynamicBitset frontier(const DynamicBitset &researched) const;
+	private:
+		static Ids idsIn(const QVector<int> &offsets, const QVector<int> &targets, int id);
+		bool hasPrerequisites(int id, const DynamicBitset &researched) const;
+
+		QVector<const Technology *> techs;
+		QHash<QString, int> ids;
+		QVector<int> prerequisiteOffsets, prerequisiteIds;  // prerequisites of i: prerequisiteIds[offsets[i]..offsets[i + 1]]
+		QVector<int> dependentOffsets, dependentIds;
+		QVector<DynamicBitset> ancestorSets, descendantSets;
+	};
+}
+
+#endif //STELLARIS_STAT_VIEWER_TECHGRAPH_H
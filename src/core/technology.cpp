@@ -17,12 +17,21 @@
 
 #include "technology.h"
 
+#include <QtCore/QDataStream>
+
+#include "keyword_table.h"
 #include "model_private_macros.h"
 #include "parser.h"
 
 using Parsing::AstNode;
 
 namespace Galaxy {
+	static constexpr Parsing::KeywordTable<TechArea, 3> techAreas({{
+		{ "physics", TechArea::Physics },
+		{ "society", TechArea::Society },
+		{ "engineering", TechArea::Engineering }
+	}});
+
 	Technology::Technology(QObject *parent) : QObject(parent) {}
 
 	const QString &Technology::getName() const {
@@ -67,9 +76,7 @@ namespace Galaxy {
 		
 		AstNode *areaNode = node->findChildWithName("area");
 		CHECK_PTR(areaNode);
-		if (qstrcmp(areaNode->val.Str, "engineering") == 0) state->area = TechArea::Engineering;
-		else if (qstrcmp(areaNode->val.Str, "society") == 0) state->area = TechArea::Society;
-		else if (qstrcmp(areaNode->val.Str, "physics") == 0) state->area = TechArea::Physics;
+		if (auto area = techAreas.find(areaNode->val.Str)) state->area = *area;
 		else { delete state; return nullptr; }
 		
 		AstNode *startTechNode = node->findChildWithName("start_tech");
@@ -120,4 +127,30 @@ namespace Galaxy {
 		
 		return state;
 	}
-}
\ No newline at end of file
+
+	void Technology::serialize(QDataStream &out) const {
+		out << name << requirements << (quint32) weightModifyingTechs.size();
+		for (const WeightModifier &modifier : weightModifyingTechs) out << modifier.tech << modifier.modifier;
+		out << isStartingTech << isRare << isRepeatable << isWeightZero << (qint32) tier << (qint32) area;
+	}
+
+	Technology *Technology::deserialize(QDataStream &in, QObject *parent) {
+		Technology *state = new Technology(parent);
+		quint32 modifierCount;
+		in >> state->name >> state->requirements >> modifierCount;
+		for (quint32 i = 0; i < modifierCount && in.status() == QDataStream::Ok; i++) {
+			WeightModifier modifier;
+			in >> modifier.tech >> modifier.modifier;
+			state->weightModifyingTechs.append(modifier);
+		}
+		qint32 tier, area;
+		in >> state->isStartingTech >> state->isRare >> state->isRepeatable >> state->isWeightZero >> tier >> area;
+		state->tier = tier;
+		state->area = static_cast<TechArea>(area);
+		if (in.status() != QDataStream::Ok || area < 0 || area > static_cast<qint32>(TechArea::Engineering)) {
+			delete state;
+			return nullptr;
+		}
+		return state;
+	}
+}
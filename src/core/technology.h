@@ -24,6 +24,7 @@
 #include <QtCore/QStringList>
 #include <QtCore/QObject>
 
+class QDataStream;
 namespace Parsing { struct AstNode; }
 
 namespace Galaxy {
@@ -52,6 +53,11 @@ namespace Galaxy {
 
 		TechArea getArea() const;
 		static Technology *createFromAst(const Parsing::AstNode *node, QObject *parent);
+
+		/** Write everything that createFromAst extracted, for reading back with deserialize(). */
+		void serialize(QDataStream &out) const;
+		/** Returns nullptr if the stream does not hold a valid technology. */
+		static Technology *deserialize(QDataStream &in, QObject *parent);
 	private:
 		Technology(QObject *parent = nullptr);
 		QString name;
@@ -1,4 +1,4 @@
-/* techtree.cpp: Writing dot files from technologies
+/* techtree.cpp: Laying out the tech tree
  *
  * Copyright 2019 Adrian "ArdiMaster" Welcker
  *
@@ -17,74 +17,297 @@
 
 #include "techtree.h"
 
-#include <QtCore/QFile>
+#include <algorithm>
+#include <utility>
+
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtCore/QHash>
 
-#include "galaxy_model.h"
 #include "gametranslator.h"
 #include "technology.h"
 
-void writeTechTreePreamble(QFile *out) {
-	out->write("strict digraph techs {\nnode[shape=box];ranksep=1.5;concentrate=true;rankdir=LR;\n");
+using Galaxy::Technology;
+
+static const qreal layerGap = 80;   // horizontal space between columns, for the arrows
+static const qreal nodeGap = 12;    // vertical space between boxes in a column
+static const qreal areaGap = 60;    // vertical space between the research areas' bands
+static const int orderingSweeps = 12;
+static const int placementSweeps = 6;
+static const int areaCount = static_cast<int>(Galaxy::TechArea::Engineering) + 1;
+
+/* @p The layout of one research area.
+ * Each area is laid out on its own (and in parallel with the others). Every technology of the area is
+ * a vertex; additionally, every prerequisite relation within the area that spans several columns gets
+ * a dummy vertex in each column it passes through, so that all edges of the graph connect neighbouring
+ * columns and long arrows take part in avoiding crossings like everything else.
+ */
+struct AreaGraph {
+	QVector<int> node;                  // vertex -> index into TechTreeLayout::nodes, -1 for dummies
+	QVector<int> rank;                  // vertex -> column
+	QVector<qreal> height;              // vertex -> height of its box, 0 for dummies
+	QVector<QVector<int>> preds, succs;
+	QVector<QVector<int>> layers;       // column -> vertices, top to bottom
+	QVector<int> position;              // vertex -> index within its column
+	QVector<qreal> y;                   // vertex -> vertical center, relative to the area's band
+	QHash<int, QVector<int>> bends;     // edge index -> its dummy vertices, left to right
+	qreal extent = 0;                   // height of the band
+
+	int addVertex(int nodeIndex, int vertexRank, qreal vertexHeight) {
+		node.append(nodeIndex);
+		rank.append(vertexRank);
+		height.append(vertexHeight);
+		preds.append(QVector<int>());
+		succs.append(QVector<int>());
+		if (layers.size() <= vertexRank) layers.resize(vertexRank + 1);
+		layers[vertexRank].append(node.size() - 1);
+		return node.size() - 1;
+	}
+	void link(int from, int to) {
+		succs[from].append(to);
+		preds[to].append(from);
+	}
+};
+
+// Column of each technology: one further right than the furthest right of its prerequisites, but no
+// further left than its tier. Prerequisites that (erroneously) form a cycle are ignored.
+static int rankOf(int v, const QVector<QVector<int>> &requirements, const QVector<TechTreeLayout::Node> &nodes,
+		QVector<int> &rank, QVector<char> &state) {
+	if (state[v] == 2) return rank[v];
+	if (state[v] == 1) return -1;
+	state[v] = 1;
+	int result = std::max(nodes[v].tech->getTier(), 0);
+	for (int req : requirements[v]) {
+		int reqRank = rankOf(req, requirements, nodes, rank, state);
+		if (reqRank >= 0) result = std::max(result, reqRank + 1);
+	}
+	rank[v] = result;
+	state[v] = 2;
+	return result;
 }
 
-void writeTechTreeClosing(QFile *out) {
-	out->write("}\n");
+static void updatePositions(AreaGraph &g, int layer) {
+	for (int i = 0; i < g.layers[layer].size(); i++) g.position[g.layers[layer][i]] = i;
 }
 
-void writeTechTreeNodes(QFile *out, const QMap<QString, Galaxy::Technology *> &techs, const GameTranslator *translator) {
-	for (auto it = techs.cbegin(); it != techs.cend(); it++) {
-		Galaxy::Technology *tech = it.value();
-		out->write(it.key().toUtf8());
-		switch (tech->getArea()) {
-		case Galaxy::TechArea::Physics:
-			out->write("[color=blue");
-			break;
-		case Galaxy::TechArea::Society:
-			out->write("[color=forestgreen");
-			break;
-		case Galaxy::TechArea::Engineering:
-			out->write("[color=orange");
-			break;
+// Number of crossings between the edges from `layer' to the next column, counted as the inversions
+// in the targets' positions once the edges are sorted by their sources' positions.
+static qint64 crossingsAfter(const AreaGraph &g, int layer) {
+	QVector<QPair<int, int>> edges;
+	for (int v : g.layers[layer]) {
+		for (int w : g.succs[v]) edges.append(qMakePair(g.position[v], g.position[w]));
+	}
+	std::sort(edges.begin(), edges.end());
+	const int targets = g.layers[layer + 1].size();
+	QVector<int> tree(targets + 1, 0);  // Fenwick tree over target positions seen so far
+	qint64 crossings = 0;
+	for (int i = 0; i < edges.size(); i++) {
+		int seenNotAfter = 0;
+		for (int j = edges[i].second + 1; j > 0; j -= j & -j) seenNotAfter += tree[j];
+		crossings += i - seenNotAfter;
+		for (int j = edges[i].second + 1; j <= targets; j += j & -j) tree[j]++;
+	}
+	return crossings;
+}
+
+static qint64 crossings(const AreaGraph &g) {
+	qint64 result = 0;
+	for (int layer = 0; layer + 1 < g.layers.size(); layer++) result += crossingsAfter(g, layer);
+	return result;
+}
+
+// Sort the vertices of `layer' by the mean position of their neighbours in the adjacent column.
+// Vertices without neighbours there keep their place.
+static void reorder(AreaGraph &g, int layer, const QVector<QVector<int>> &neighbours) {
+	QVector<int> &vertices = g.layers[layer];
+	QVector<qreal> barycenter(g.node.size());
+	for (int v : vertices) {
+		if (neighbours[v].isEmpty()) {
+			barycenter[v] = g.position[v];
+			continue;
 		}
-		out->write(",label=\"");
-		out->write(translator->getTranslationOf(it.key()).toUtf8());
-		out->write("\"");
-		if (tech->getIsStartingTech()) {
-			out->write(",style=filled,fillcolor=green");
-		} else if (tech->getIsWeightZero()) {
-			out->write(",style=filled,fillcolor=gray");
-		} else if (tech->getIsRare()) {
-			out->write(",style=filled,fillcolor=darkorchid");
+		qreal sum = 0;
+		for (int n : neighbours[v]) sum += g.position[n];
+		barycenter[v] = sum / neighbours[v].size();
+	}
+	std::stable_sort(vertices.begin(), vertices.end(), [&barycenter](int a, int b) {
+		return barycenter[a] < barycenter[b];
+	});
+	updatePositions(g, layer);
+}
+
+static void orderLayers(AreaGraph &g) {
+	g.position.resize(g.node.size());
+	for (int layer = 0; layer < g.layers.size(); layer++) updatePositions(g, layer);
+	QVector<QVector<int>> best(g.layers);
+	qint64 bestCrossings = crossings(g);
+	for (int sweep = 0; sweep < orderingSweeps && bestCrossings > 0; sweep++) {
+		if (sweep % 2 == 0) {
+			for (int layer = 1; layer < g.layers.size(); layer++) reorder(g, layer, g.preds);
+		} else {
+			for (int layer = g.layers.size() - 2; layer >= 0; layer--) reorder(g, layer, g.succs);
+		}
+		qint64 current = crossings(g);
+		if (current < bestCrossings) {
+			best = g.layers;
+			bestCrossings = current;
 		}
-		out->write("];\n");
 	}
+	g.layers = best;
+	for (int layer = 0; layer < g.layers.size(); layer++) updatePositions(g, layer);
 }
 
-void writeTechTreeRelations(QFile *out, const QMap<QString, Galaxy::Technology *> &techs, bool enableWeights) {
-	for (auto it = techs.cbegin(); it != techs.cend(); it++) {
-		const QStringList &reqs = it.value()->getRequirements();
-		const QString &tech = it.key();
-		for (const auto &aReq: reqs) {
-			out->write(aReq.toUtf8().data());
-			out->write("->");
-			out->write(tech.toUtf8().data());
-			out->write(";\n");
+static qreal separation(const AreaGraph &g, int upper, int lower) {
+	return (g.height[upper] + g.height[lower]) / 2 + nodeGap;
+}
+
+// Move the vertices of `layer' as close to the mean height of their neighbours as the order and the
+// spacing within the column allow. Packing the column from the top and from the bottom both give
+// valid placements; their mean is one too, and doesn't favour either direction.
+static void place(AreaGraph &g, int layer, const QVector<QVector<int>> &neighbours) {
+	const QVector<int> &vertices = g.layers[layer];
+	const int count = vertices.size();
+	if (count == 0) return;
+	QVector<qreal> wanted(count), fromTop(count), fromBottom(count);
+	for (int i = 0; i < count; i++) {
+		const int v = vertices[i];
+		if (neighbours[v].isEmpty()) {
+			wanted[i] = g.y[v];
+			continue;
 		}
-		if (enableWeights) {
-			const auto &wms = it.value()->getWeightModifyingTechs();
-			for (const auto &wm: wms) {
-				out->write(wm.tech.toUtf8().data());
-				out->write(" -> ");
-				out->write(tech.toUtf8().data());
-				out->write(" [style=dashed, color=");
-				if (wm.modifier < 1.0) {
-					out->write("red");
-				} else {
-					out->write("forestgreen");
-				}
-				out->write("];\n");
-			}
+		qreal sum = 0;
+		for (int n : neighbours[v]) sum += g.y[n];
+		wanted[i] = sum / neighbours[v].size();
+	}
+	fromTop[0] = wanted[0];
+	for (int i = 1; i < count; i++) {
+		fromTop[i] = std::max(wanted[i], fromTop[i - 1] + separation(g, vertices[i - 1], vertices[i]));
+	}
+	fromBottom[count - 1] = wanted[count - 1];
+	for (int i = count - 2; i >= 0; i--) {
+		fromBottom[i] = std::min(wanted[i], fromBottom[i + 1] - separation(g, vertices[i], vertices[i + 1]));
+	}
+	for (int i = 0; i < count; i++) g.y[vertices[i]] = (fromTop[i] + fromBottom[i]) / 2;
+}
+
+static void assignHeights(AreaGraph &g) {
+	g.y.resize(g.node.size());
+	for (const QVector<int> &vertices : std::as_const(g.layers)) {
+		qreal top = 0;
+		for (int v : vertices) {
+			g.y[v] = top + g.height[v] / 2;
+			top += g.height[v] + nodeGap;
+		}
+	}
+	for (int sweep = 0; sweep < placementSweeps; sweep++) {
+		if (sweep % 2 == 0) {
+			for (int layer = 1; layer < g.layers.size(); layer++) place(g, layer, g.preds);
+		} else {
+			for (int layer = g.layers.size() - 2; layer >= 0; layer--) place(g, layer, g.succs);
 		}
 	}
+
+	if (g.node.isEmpty()) return;
+	qreal top = g.y[0] - g.height[0] / 2, bottom = g.y[0] + g.height[0] / 2;
+	for (int v = 1; v < g.node.size(); v++) {
+		top = std::min(top, g.y[v] - g.height[v] / 2);
+		bottom = std::max(bottom, g.y[v] + g.height[v] / 2);
+	}
+	for (qreal &y : g.y) y -= top;
+	g.extent = bottom - top;
 }
 
+TechTreeLayout layoutTechTree(const QMap<QString, Technology *> &techs, bool includeWeights,
+		const GameTranslator *translator, const std::function<QSizeF(const QString &label)> &nodeSize) {
+	TechTreeLayout result;
+	if (techs.isEmpty()) return result;
+	QHash<QString, int> indexOf;
+	result.nodes.reserve(techs.size());
+	for (auto it = techs.cbegin(); it != techs.cend(); it++) {
+		const QString label(translator->getTranslationOf(it.key()));
+		indexOf.insert(it.key(), result.nodes.size());
+		result.nodes.append({ it.value(), label, QRectF(QPointF(), nodeSize(label)) });
+	}
+
+	QVector<QVector<int>> requirements(result.nodes.size());
+	for (int to = 0; to < result.nodes.size(); to++) {
+		const Technology *tech = result.nodes[to].tech;
+		for (const QString &req : tech->getRequirements()) {
+			const int from = indexOf.value(req, -1);
+			if (from < 0 || from == to) continue;
+			requirements[to].append(from);
+			result.edges.append({ TechTreeLayout::EdgeKind::Requirement, from, to, QVector<QPointF>() });
+		}
+		if (!includeWeights) continue;
+		for (const Galaxy::WeightModifier &wm : tech->getWeightModifyingTechs()) {
+			const int from = indexOf.value(wm.tech, -1);
+			if (from < 0 || from == to) continue;
+			const auto kind = wm.modifier < 1.0 ? TechTreeLayout::EdgeKind::WeightDecrease : TechTreeLayout::EdgeKind::WeightIncrease;
+			result.edges.append({ kind, from, to, QVector<QPointF>() });
+		}
+	}
+
+	QVector<int> rank(result.nodes.size(), 0);
+	QVector<char> state(result.nodes.size(), 0);
+	for (int v = 0; v < result.nodes.size(); v++) rankOf(v, requirements, result.nodes, rank, state);
+
+	QVector<AreaGraph> areas(areaCount);
+	QVector<int> areaOf(result.nodes.size()), vertexOf(result.nodes.size());
+	for (int v = 0; v < result.nodes.size(); v++) {
+		areaOf[v] = static_cast<int>(result.nodes[v].tech->getArea());
+		vertexOf[v] = areas[areaOf[v]].addVertex(v, rank[v], result.nodes[v].rect.height());
+	}
+	for (int e = 0; e < result.edges.size(); e++) {
+		const TechTreeLayout::Edge &edge = result.edges[e];
+		// Weight modifiers, prerequisites from other areas and the odd cyclic prerequisite are drawn
+		// as they come, without influencing the layout.
+		if (edge.kind != TechTreeLayout::EdgeKind::Requirement || areaOf[edge.from] != areaOf[edge.to]
+				|| rank[edge.from] >= rank[edge.to]) continue;
+		AreaGraph &g = areas[areaOf[edge.from]];
+		int previous = vertexOf[edge.from];
+		for (int r = rank[edge.from] + 1; r < rank[edge.to]; r++) {
+			const int dummy = g.addVertex(-1, r, 0);
+			g.bends[e].append(dummy);
+			g.link(previous, dummy);
+			previous = dummy;
+		}
+		g.link(previous, vertexOf[edge.to]);
+	}
+
+	QtConcurrent::blockingMap(areas, [](AreaGraph &g) {
+		orderLayers(g);
+		assignHeights(g);
+	});
+
+	// All areas share the same columns, each of them as wide as its widest box.
+	const int columns = *std::max_element(rank.cbegin(), rank.cend()) + 1;
+	QVector<qreal> columnWidth(columns, 0), columnLeft(columns, 0);
+	for (int v = 0; v < result.nodes.size(); v++) {
+		columnWidth[rank[v]] = std::max(columnWidth[rank[v]], result.nodes[v].rect.width());
+	}
+	for (int c = 1; c < columns; c++) columnLeft[c] = columnLeft[c - 1] + columnWidth[c - 1] + layerGap;
+
+	QVector<qreal> bandTop(areaCount, 0);
+	for (int a = 1; a < areaCount; a++) {
+		bandTop[a] = bandTop[a - 1] + areas[a - 1].extent + (areas[a - 1].extent > 0 ? areaGap : 0);
+	}
+	qreal height = 0;
+	for (int a = 0; a < areaCount; a++) height = std::max(height, bandTop[a] + areas[a].extent);
+	for (int v = 0; v < result.nodes.size(); v++) {
+		const AreaGraph &g = areas[areaOf[v]];
+		QRectF &rect = result.nodes[v].rect;
+		rect.moveCenter(QPointF(columnLeft[rank[v]] + columnWidth[rank[v]] / 2, bandTop[areaOf[v]] + g.y[vertexOf[v]]));
+	}
+	for (int e = 0; e < result.edges.size(); e++) {
+		TechTreeLayout::Edge &edge = result.edges[e];
+		const QRectF &from = result.nodes[edge.from].rect, &to = result.nodes[edge.to].rect;
+		edge.points.append(QPointF(from.right(), from.center().y()));
+		const AreaGraph &g = areas[areaOf[edge.from]];
+		for (int dummy : g.bends.value(e)) {
+			edge.points.append(QPointF(columnLeft[g.rank[dummy]] + columnWidth[g.rank[dummy]] / 2, bandTop[areaOf[edge.from]] + g.y[dummy]));
+		}
+		edge.points.append(QPointF(to.left(), to.center().y()));
+	}
+
+	result.size = QSizeF(columnLeft.last() + columnWidth.last(), height);
+	return result;
+}
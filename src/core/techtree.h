@@ -1,4 +1,4 @@
-/* techtree.h: Writing dot files from technologies (header file)
+/* techtree.h: Laying out the tech tree (header file)
  *
  * Copyright 2019 Adrian "ArdiMaster" Welcker
  *
@@ -18,17 +18,48 @@
 #ifndef STELLARIS_STAT_VIEWER_TECHTREE_H
 #define STELLARIS_STAT_VIEWER_TECHTREE_H
 
+#include <functional>
+
 #include <QtCore/QMap>
+#include <QtCore/QPointF>
+#include <QtCore/QRectF>
+#include <QtCore/QSizeF>
 #include <QtCore/QString>
+#include <QtCore/QVector>
 
 class GameTranslator;
-class QFile;
 namespace Galaxy { class Technology; }
 
-void writeTechTreePreamble(QFile *out);
-void writeTechTreeClosing(QFile *out);
+/** Where everything in a drawing of the tech tree goes, with prerequisites on the left. */
+struct TechTreeLayout {
+	struct Node {
+		const Galaxy::Technology *tech;
+		QString label;
+		QRectF rect;
+	};
+	enum class EdgeKind {
+		Requirement,
+		WeightIncrease,
+		WeightDecrease
+	};
+	struct Edge {
+		EdgeKind kind;
+		int from, to;  // indices into nodes
+		/** From the middle of the source's right side, through any bends, to the middle of the target's left side. */
+		QVector<QPointF> points;
+	};
+
+	QVector<Node> nodes;
+	QVector<Edge> edges;
+	QSizeF size;
+};
 
-void writeTechTreeNodes(QFile *out, const QMap<QString, Galaxy::Technology *> &techs, const GameTranslator *translator);
-void writeTechTreeRelations(QFile *out, const QMap<QString, Galaxy::Technology *> &techs, bool enableWeights);
+/** Lay out `techs' as a layered graph: each technology goes into the column given by the longest chain
+ *  of prerequisites leading up to it (but no further left than its tier), the order within each column
+ *  is chosen to avoid crossing arrows, and each research area gets a band of its own. `nodeSize' returns
+ *  the size of the box for a technology's (translated) name. Weight modifiers are only included as edges
+ *  if `includeWeights' is set; they do not affect where technologies go. */
+TechTreeLayout layoutTechTree(const QMap<QString, Galaxy::Technology *> &techs, bool includeWeights,
+		const GameTranslator *translator, const std::function<QSizeF(const QString &label)> &nodeSize);
 
 #endif //STELLARIS_STAT_VIEWER_TECHTREE_H
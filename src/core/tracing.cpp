@@ -0,0 +1,156 @@
+/* core/tracing.cpp: Recording a timeline of a load as a Chrome trace.
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tracing.h"
+
+#ifdef SSV_ENABLE_TRACING
+#include <memory>
+#include <vector>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QSaveFile>
+#include <QtCore/QThread>
+#endif
+
+#include <QtCore/QByteArray>
+#include <QtCore/QtGlobal>
+
+namespace Tracing {
+#ifdef SSV_ENABLE_TRACING
+	std::atomic<bool> recording { false };
+
+	namespace {
+		struct Event {
+			const char *name;
+			qint64 begin;
+			qint64 end;
+		};
+
+		// Each thread appends to its own log; the mutex is only ever contended while stop() writes.
+		struct ThreadLog {
+			int id;
+			QByteArray threadName;
+			QMutex mutex;
+			std::vector<Event> events;
+		};
+
+		QElapsedTimer clock;
+		QString traceFile;
+		QMutex logsMutex;  // guards the list, not the logs
+		std::vector<std::unique_ptr<ThreadLog>> logs;
+		thread_local ThreadLog *currentLog = nullptr;
+
+		ThreadLog *logForThisThread() {
+			if (!currentLog) {
+				QMutexLocker locker(&logsMutex);
+				logs.emplace_back(new ThreadLog);
+				currentLog = logs.back().get();
+				currentLog->id = logs.size();
+				const QString name(QThread::currentThread()->objectName());
+				currentLog->threadName = name.isEmpty() ? "Thread " + QByteArray::number(currentLog->id) : name.toUtf8();
+			}
+			return currentLog;
+		}
+
+		void appendEscaped(QByteArray &out, const QByteArray &text) {
+			for (char c : text) {
+				if (c == '"' || c == '\\') out += '\\';
+				if (static_cast<unsigned char>(c) >= 0x20) out += c;
+			}
+		}
+	}
+
+	qint64 now() {
+		return clock.nsecsElapsed();
+	}
+
+	void record(const char *name, qint64 begin, qint64 end) {
+		ThreadLog *log = logForThisThread();
+		QMutexLocker locker(&log->mutex);
+		log->events.push_back({ name, begin, end });
+	}
+
+	bool isAvailable() {
+		return true;
+	}
+
+	bool start(const QString &fileName) {
+		QMutexLocker locker(&logsMutex);
+		if (recording || fileName.isEmpty()) return false;
+		traceFile = fileName;
+		clock.start();
+		recording = true;
+		return true;
+	}
+
+	bool stop() {
+		QMutexLocker locker(&logsMutex);
+		if (!recording.exchange(false)) return false;
+
+		// Timestamps are in microseconds; thread names come first as metadata events.
+		QSaveFile file(traceFile);
+		if (!file.open(QIODevice::WriteOnly)) return false;
+		QByteArray out("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+		bool first = true;
+		for (const auto &log : logs) {
+			if (!first) out += ",\n";
+			first = false;
+			out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + QByteArray::number(log->id)
+					+ ",\"args\":{\"name\":\"";
+			appendEscaped(out, log->threadName);
+			out += "\"}}";
+		}
+		for (const auto &log : logs) {
+			QMutexLocker logLocker(&log->mutex);
+			for (const Event &event : log->events) {
+				out += ",\n{\"name\":\"";
+				appendEscaped(out, event.name);
+				out += "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + QByteArray::number(log->id)
+						+ ",\"ts\":" + QByteArray::number(event.begin / 1e3, 'f', 3)
+						+ ",\"dur\":" + QByteArray::number((event.end - event.begin) / 1e3, 'f', 3) + "}";
+				if (out.size() >= (1 << 20)) {
+					file.write(out);
+					out.clear();
+				}
+			}
+			log->events.clear();
+		}
+		out += "\n]}\n";
+		file.write(out);
+		return file.commit();
+	}
+#else
+	bool isAvailable() {
+		return false;
+	}
+
+	bool start(const QString &) {
+		return false;
+	}
+
+	bool stop() {
+		return false;
+	}
+#endif
+
+	bool startFromEnvironment() {
+		const QByteArray fileName(qgetenv("SSV_TRACE_FILE"));
+		if (fileName.isEmpty()) return false;
+		return start(QString::fromLocal8Bit(fileName));
+	}
+}
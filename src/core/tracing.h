@@ -0,0 +1,88 @@
+/* core/tracing.h: Recording a timeline of a load as a Chrome trace (header file)
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#ifndef STELLARIS_STAT_VIEWER_TRACING_H
+#define STELLARIS_STAT_VIEWER_TRACING_H
+
+#include <atomic>
+
+#include <QtCore/QString>
+
+/** A per-thread timeline of where the time goes, written in the Chrome trace event format so that it
+ *  can be opened in chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Tracing has to be compiled in (the SSV_ENABLE_TRACING CMake option) and then switched on at run time,
+ * either by setting the SSV_TRACE_FILE environment variable or, in the JSON frontend, with --trace=FILE.
+ * Without the CMake option, SSV_TRACE_SCOPE expands to nothing; with it, a scope costs one relaxed
+ * atomic load while tracing is off.
+ */
+namespace Tracing {
+	/** Whether tracing support has been compiled in. */
+	bool isAvailable();
+	/** Start recording, to be written to `fileName' by stop(). Returns false if tracing is not
+	 *  available or already running. */
+	bool start(const QString &fileName);
+	/** Start recording if the SSV_TRACE_FILE environment variable names a file. */
+	bool startFromEnvironment();
+	/** Stop recording and write everything recorded so far. Returns false if nothing was being
+	 *  recorded or the file could not be written. Safe to call when tracing is off. */
+	bool stop();
+
+	/** Stops tracing when destroyed, so that every way out of a function writes the trace. */
+	class StopGuard {
+	public:
+		StopGuard() = default;
+		StopGuard(const StopGuard &) = delete;
+		StopGuard &operator=(const StopGuard &) = delete;
+		inline ~StopGuard() { stop(); }
+	};
+
+#ifdef SSV_ENABLE_TRACING
+	extern std::atomic<bool> recording;
+	/** Nanoseconds since tracing was started. */
+	qint64 now();
+	void record(const char *name, qint64 begin, qint64 end);
+
+	/** Records the time from its construction to its destruction on the current thread's timeline.
+	 *  `name' must outlive the trace; use string literals. */
+	class Scope {
+	public:
+		inline explicit Scope(const char *name)
+				: name(name), begin(recording.load(std::memory_order_relaxed) ? now() : -1) {}
+		Scope(const Scope &) = delete;
+		Scope &operator=(const Scope &) = delete;
+		inline ~Scope() {
+			if (begin >= 0) record(name, begin, now());
+		}
+	private:
+		const char *name;
+		qint64 begin;
+	};
+#endif
+}
+
+#ifdef SSV_ENABLE_TRACING
+#define SSV_TRACE_CONCAT_(a, b) a##b
+#define SSV_TRACE_CONCAT(a, b) SSV_TRACE_CONCAT_(a, b)
+#define SSV_TRACE_SCOPE(name) ::Tracing::Scope SSV_TRACE_CONCAT(ssvTraceScope, __LINE__)(name)
+#else
+#define SSV_TRACE_SCOPE(name) do {} while (0)
+#endif
+
+#endif //STELLARIS_STAT_VIEWER_TRACING_H
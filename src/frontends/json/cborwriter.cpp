@@ -0,0 +1,68 @@
+/* frontends/json/cborwriter.cpp: Binary (CBOR) counterpart to JsonWriter.
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cborwriter.h"
+
+#include <QtCore/QFileDevice>
+#include <QtCore/QString>
+
+CborWriter::CborWriter(QIODevice *out) : out(out), writer(out) {}
+
+void CborWriter::beginObject(qsizetype size) {
+	if (size < 0) writer.startMap();
+	else writer.startMap(static_cast<quint64>(size));
+}
+
+void CborWriter::endObject() {
+	writer.endMap();
+}
+
+void CborWriter::beginArray(qsizetype size) {
+	if (size < 0) writer.startArray();
+	else writer.startArray(static_cast<quint64>(size));
+}
+
+void CborWriter::endArray() {
+	writer.endArray();
+}
+
+void CborWriter::key(const char *name) {
+	// keys are plain ASCII, so they can go out as UTF-8 without conversion
+	writer.appendTextString(name, qstrlen(name));
+}
+
+void CborWriter::key(const QString &name) {
+	writer.append(name);
+}
+
+void CborWriter::value(const QString &val) {
+	writer.append(val);
+}
+
+void CborWriter::value(double val) {
+	writer.append(val);
+}
+
+void CborWriter::value(qint64 val) {
+	writer.append(val);
+}
+
+bool CborWriter::flush() {
+	// QCborStreamWriter doesn't report errors itself, so ask the device instead.
+	if (auto *file = qobject_cast<QFileDevice *>(out)) return file->error() == QFileDevice::NoError;
+	return true;
+}
@@ -0,0 +1,56 @@
+/* frontends/json/cborwriter.h: Binary (CBOR) counterpart to JsonWriter (header file)
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#ifndef STELLARIS_STAT_VIEWER_CBORWRITER_H
+#define STELLARIS_STAT_VIEWER_CBORWRITER_H
+
+#include <QtCore/QCborStreamWriter>
+
+class QIODevice;
+class QString;
+
+/** Writes the same structure as JsonWriter, but as CBOR (RFC 8949).
+ *
+ * Whenever the caller passes a size to beginObject/beginArray, the container is written with
+ * a length prefix, so readers can preallocate instead of scanning for the end marker.
+ */
+class CborWriter {
+	Q_DISABLE_COPY(CborWriter)
+public:
+	explicit CborWriter(QIODevice *out);
+
+	void beginObject(qsizetype size = -1);
+	void endObject();
+	void beginArray(qsizetype size = -1);
+	void endArray();
+	void key(const char *name);
+	void key(const QString &name);
+	void value(const QString &val);
+	void value(double val);
+	void value(qint64 val);
+
+	/** Returns false if any write so far has failed. */
+	bool flush();
+
+private:
+	QIODevice *out;
+	QCborStreamWriter writer;
+};
+
+#endif //STELLARIS_STAT_VIEWER_CBORWRITER_H
@@ -1,4 +1,4 @@
-/* frontends/json/dataextraction.cpp: Putting stats into JSON objects.
+/* frontends/json/dataextraction.cpp: Writing stats as JSON.
  *
  * Copyright 2019 Adrian "ArdiMaster" Welcker
  *
@@ -15,142 +15,167 @@
  * limitations under the License.
  */
 
-#include <QtCore/QJsonArray>
 #include "dataextraction.h"
 
+#include <QtCore/QIODevice>
+
+#include "cborwriter.h"
+#include "jsonwriter.h"
 #include "../../core/empire.h"
-#include "../../core/fleet.h"
-#include "../../core/ship.h"
 #include "../../core/ship_design.h"
 #include "../../core/galaxy_state.h"
-
-QJsonObject getOverviewForEmpire(const Galaxy::Empire *empire) {
-	QJsonObject overview;
-	overview["military"] = empire->getMilitaryPower();
-	overview["economy"] = empire->getEconomyPower();
-	overview["technology"] = empire->getTechPower();
-	overview["systemsOwned"] = (qint64) empire->getOwnedSystemsCount();
-	return overview;
+#include "../../core/tracing.h"
+
+// Everything below is written through either a JsonWriter or a CborWriter, which share the same interface.
+// Members are written in alphabetical order within each object, matching what QJsonObject used to produce.
+
+template <typename Writer>
+static void writeOverviewForEmpire(Writer &writer, const Galaxy::Empire *empire, const Galaxy::EmpireAggregates &totals) {
+	writer.beginObject(4);
+	writer.key("economy");
+	writer.value(empire->getEconomyPower());
+	writer.key("military");
+	writer.value(empire->getMilitaryPower());
+	writer.key("systemsOwned");
+	writer.value((qint64) totals.ownedSystems);
+	writer.key("technology");
+	writer.value(empire->getTechPower());
+	writer.endObject();
 }
 
-QJsonObject getFleetsForEmpire(const std::forward_list<Galaxy::Ship *> &shipsOfEmpire) {
-	QJsonObject fleetObj;
+template <typename Writer>
+static void writeFleetsForEmpire(Writer &writer, const Galaxy::EmpireAggregates &totals) {
 	using Galaxy::ShipSize;
-	using Galaxy::FleetData;
-
-	FleetData empireTotals { 0, 0, 0, 0, 0, 0, 0, 0 };
-	for (auto ship : shipsOfEmpire) {
-		Galaxy::ShipDesign *design = ship->getDesign();
-		switch (design->getSize()) {
-			case ShipSize::Corvette:
-				empireTotals.corvettes += 1;
-				break;
-			case ShipSize::Destroyer:
-				empireTotals.destroyers += 1;
-				break;
-			case ShipSize::Cruiser:
-				empireTotals.cruisers += 1;
-				break;
-			case ShipSize::Battleship:
-				empireTotals.battleships += 1;
-				break;
-			case ShipSize::Titan:
-				empireTotals.titans += 1;
-				break;
-			case ShipSize::Colossus:
-				empireTotals.colossi += 1;
-				break;
-			case ShipSize::FallenSmallShip:
-			case ShipSize::FallenLargeShip:
-			case ShipSize::FallenMassiveShip:
-				empireTotals.fallen += 1;
-				break;
-				/* case ShipSize::INVALID:
-					Q_UNREACHABLE(); */  // meh
-			default:
-				continue;
-		}
-	}
 
-	fleetObj["corvettes"] = (qint64) empireTotals.corvettes;
-	fleetObj["destroyers"] = (qint64) empireTotals.destroyers;
-	fleetObj["cruisers"] = (qint64) empireTotals.cruisers;
-	fleetObj["battleships"] = (qint64) empireTotals.battleships;
-	fleetObj["titans"] = (qint64) empireTotals.titans;
-	fleetObj["colossi"] = (qint64) empireTotals.colossi;
-	fleetObj["fallen"] = (qint64) empireTotals.fallen;
-	return fleetObj;
+	writer.beginObject(7);
+	writer.key("battleships");
+	writer.value((qint64) totals.ships(ShipSize::Battleship));
+	writer.key("colossi");
+	writer.value((qint64) totals.ships(ShipSize::Colossus));
+	writer.key("corvettes");
+	writer.value((qint64) totals.ships(ShipSize::Corvette));
+	writer.key("cruisers");
+	writer.value((qint64) totals.ships(ShipSize::Cruiser));
+	writer.key("destroyers");
+	writer.value((qint64) totals.ships(ShipSize::Destroyer));
+	writer.key("fallen");
+	writer.value((qint64) (totals.ships(ShipSize::FallenSmallShip) + totals.ships(ShipSize::FallenLargeShip)
+			+ totals.ships(ShipSize::FallenMassiveShip)));
+	writer.key("titans");
+	writer.value((qint64) totals.ships(ShipSize::Titan));
+	writer.endObject();
 }
 
-QJsonObject getEconomyForEmpire(const Galaxy::Empire *empire) {
-	QJsonObject economy;
-	const QMap<QString, double> &incomes = empire->getIncomes();
-	// Unfortunately, no direct conversion from QMap to QJsonObject.
-	economy["energy"] = incomes["energy"];
-	economy["minerals"] = incomes["minerals"];
-	economy["food"] = incomes["food"];
-	economy["influence"] = incomes["influence"];
-	economy["unity"] = incomes["unity"];
-	economy["alloys"] = incomes["alloys"];
-	economy["consumer_goods"] = incomes["consumer_goods"];
-	economy["volatile_motes"] = incomes["volatile_motes"];
-	economy["rare_crystals"] = incomes["rare_crystals"];
-	economy["exotic_gases"] = incomes["exotic_gases"];
-	economy["zro"] = incomes["sr_zro"];
-	economy["dark_matter"] = incomes["sr_dark_matter"];
-	economy["living_metal"] = incomes["sr_living_metal"];
-	economy["nanites"] = incomes["nanites"];
-	return economy;
+template <typename Writer>
+static void writeEconomyForEmpire(Writer &writer, const Galaxy::Empire *empire) {
+	using Galaxy::Resource;
+	writer.beginObject(14);
+	writer.key("alloys");
+	writer.value(empire->getIncome(Resource::Alloys));
+	writer.key("consumer_goods");
+	writer.value(empire->getIncome(Resource::ConsumerGoods));
+	writer.key("dark_matter");
+	writer.value(empire->getIncome(Resource::DarkMatter));
+	writer.key("energy");
+	writer.value(empire->getIncome(Resource::Energy));
+	writer.key("exotic_gases");
+	writer.value(empire->getIncome(Resource::ExoticGases));
+	writer.key("food");
+	writer.value(empire->getIncome(Resource::Food));
+	writer.key("influence");
+	writer.value(empire->getIncome(Resource::Influence));
+	writer.key("living_metal");
+	writer.value(empire->getIncome(Resource::LivingMetal));
+	writer.key("minerals");
+	writer.value(empire->getIncome(Resource::Minerals));
+	writer.key("nanites");
+	writer.value(empire->getIncome(Resource::Nanites));
+	writer.key("rare_crystals");
+	writer.value(empire->getIncome(Resource::RareCrystals));
+	writer.key("unity");
+	writer.value(empire->getIncome(Resource::Unity));
+	writer.key("volatile_motes");
+	writer.value(empire->getIncome(Resource::VolatileMotes));
+	writer.key("zro");
+	writer.value(empire->getIncome(Resource::Zro));
+	writer.endObject();
 }
 
-QJsonObject getResearchForEmpire(const Galaxy::Empire* empire) {
-	QJsonObject research;
-	const QMap<QString, double>& incomes = empire->getIncomes();
-	research["physics"] = incomes["physics_research"];
-	research["society"] = incomes["society"];
-	research["engineering"] = incomes["engineering"];
-	return research;
+template <typename Writer>
+static void writeResearchForEmpire(Writer &writer, const Galaxy::Empire* empire) {
+	using Galaxy::Resource;
+	writer.beginObject(3);
+	writer.key("engineering");
+	writer.value(empire->getIncome(Resource::EngineeringResearch));
+	writer.key("physics");
+	writer.value(empire->getIncome(Resource::PhysicsResearch));
+	writer.key("society");
+	writer.value(empire->getIncome(Resource::SocietyResearch));
+	writer.endObject();
 }
 
-QJsonArray getTechsForEmpire(const Galaxy::Empire *empire) {
-	QJsonArray arr;
-	// No direct conversion from QStringList to QJsonArray either, so ...
-	for (const auto &i : empire->getTechnologies()) {
-		arr.append(i);
+template <typename Writer>
+static void writeTechsForEmpire(Writer &writer, const Galaxy::Empire *empire, const QStringList &names) {
+	const Galaxy::DynamicBitset &techs = empire->getTechnologies();
+	writer.beginArray(techs.count());
+	for (int id = techs.next(0); id >= 0; id = techs.next(id + 1)) {
+		writer.value(names[id]);
 	}
-	return arr;
+	writer.endArray();
 }
 
-QJsonObject createDataForEmpire(const Galaxy::Empire *empire, const std::forward_list<Galaxy::Ship *> &shipsOfEmpire) {
-	QJsonObject result;
-
-	result["overview"] = getOverviewForEmpire(empire);
-	result["military"] = getFleetsForEmpire(shipsOfEmpire);
-	result["economy"] = getEconomyForEmpire(empire);
-	result["research"] = getResearchForEmpire(empire);
-	result["technologies"] = getTechsForEmpire(empire);
-
-	return result;
+template <typename Writer>
+static void writeDataForEmpire(Writer &writer, const Galaxy::Empire *empire, const Galaxy::EmpireAggregates &totals,
+		const QStringList &techNames) {
+	writer.beginObject(5);
+	writer.key("economy");
+	writeEconomyForEmpire(writer, empire);
+	writer.key("military");
+	writeFleetsForEmpire(writer, totals);
+	writer.key("overview");
+	writeOverviewForEmpire(writer, empire, totals);
+	writer.key("research");
+	writeResearchForEmpire(writer, empire);
+	writer.key("technologies");
+	writeTechsForEmpire(writer, empire, techNames);
+	writer.endObject();
 }
 
-QJsonObject createJsonFromState(const Galaxy::State *state) {
-	QJsonObject toplevelObj;
-	toplevelObj["date"] = state->getDate();
-	QJsonObject dataObj;
-
+template <typename Writer>
+static bool writeState(Writer &writer, const Galaxy::State *state) {
 	const QMap<qint64, Galaxy::Empire *> &empires = state->getEmpires();
-	const QMap<qint64, Galaxy::Ship *> &ships = state->getShips();
-	QMap<Galaxy::Empire *, std::forward_list<Galaxy::Ship *>> shipsPerEmpire;
 
-	for (auto it = ships.cbegin(); it != ships.cend(); it++) {
-		shipsPerEmpire[it.value()->getFleet()->getOwner()].push_front(it.value());
+	// Empires are keyed by name, in name order. Where two empires share a name, the one with the higher id
+	// wins, just like it did when each one was inserted into a QJsonObject in turn.
+	QMap<QString, const Galaxy::Empire *> empiresByName;
+	for (auto it = empires.cbegin(); it != empires.cend(); it++) {
+		empiresByName.insert(it.value()->getName(), it.value());
 	}
 
-	for (auto it = empires.cbegin(); it != empires.cend(); it++) {
-		dataObj[it.value()->getName()] = createDataForEmpire(it.value(), shipsPerEmpire[it.value()]);
+	writer.beginObject(2);
+	writer.key("content");
+	writer.beginObject(empiresByName.size());
+
+	for (auto it = empiresByName.cbegin(); it != empiresByName.cend(); it++) {
+		writer.key(it.key());
+		writeDataForEmpire(writer, it.value(), state->getAggregates(it.value()), state->getTechnologyNames());
 	}
-	fprintf(stderr, "done.\n");
 
-	toplevelObj["content"] = dataObj;
-	return toplevelObj;
+	writer.endObject();
+	writer.key("date");
+	writer.value(state->getDate());
+	writer.endObject();
+	return writer.flush();
+}
+
+bool writeJsonFromState(QIODevice *out, const Galaxy::State *state, bool compact) {
+	SSV_TRACE_SCOPE("writeJsonFromState");
+	JsonWriter writer(out, compact);
+	return writeState(writer, state);
+}
+
+bool writeCborFromState(QIODevice *out, const Galaxy::State *state) {
+	SSV_TRACE_SCOPE("writeCborFromState");
+	CborWriter writer(out);
+	return writeState(writer, state);
 }
@@ -18,16 +18,13 @@
 #ifndef STELLARIS_STAT_VIEWER_DATAEXTRACTION_H
 #define STELLARIS_STAT_VIEWER_DATAEXTRACTION_H
 
-#include <forward_list>
-#include <QtCore/QJsonObject>
+class QIODevice;
 
-namespace Galaxy {
-	class Empire;
-	class Ship;
-	class State;
-}
+namespace Galaxy { class State; }
 
-QJsonObject createDataForEmpire(const Galaxy::Empire *e, const std::forward_list<Galaxy::Ship *> &ships);
-QJsonObject createJsonFromState(const Galaxy::State *state);
+/** Write the stats for the given state to `out' as JSON, empire by empire. Returns false on write errors. */
+bool writeJsonFromState(QIODevice *out, const Galaxy::State *state, bool compact = false);
+/** Write the same stats as writeJsonFromState, but as length-prefixed CBOR. Returns false on write errors. */
+bool writeCborFromState(QIODevice *out, const Galaxy::State *state);
 
 #endif //STELLARIS_STAT_VIEWER_DATAEXTRACTION_H
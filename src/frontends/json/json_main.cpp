@@ -16,45 +16,138 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <QtCore/QFile>
 #include <QtCore/QFileInfo>
-#include <QtCore/QJsonArray>
-#include <QtCore/QJsonDocument>
-#include <QtCore/QJsonObject>
-#include <QtCore/QTextStream>
 #include "../../core/empire.h"
 #include "../../core/fleet.h"
 #include "../../core/galaxy_state.h"
+#include "../../core/instrumentation.h"
+#include "../../core/tracing.h"
 #include "../../core/ship.h"
 #include "../../core/parser.h"
 #include "../../core/extract_gamestate.h"
 
 #include "dataextraction.h"
 
+#ifdef Q_OS_WIN
+#include <fcntl.h>
+#include <io.h>
+#endif
+
 using namespace Parsing;
 
+static void printUsage(const char *argv0) {
+	fprintf(stderr, "USAGE: %s --frontend=json [--compact] [--format=json|cbor] [--stats] [--trace=TRACE]\n"
+			  "       [--memory-budget=MB] [--lazy] [--recover] <FILE>\n\n"
+			  "  Read the gamestate file FILE and dump json stats to stdout\n\n"
+			  "  --compact      Omit all optional whitespace from the output\n"
+			  "  --format=cbor  Write the same stats as binary CBOR instead of JSON\n"
+			  "  --stats        Print how long each stage of loading took to stderr when done\n"
+			  "  --trace=TRACE  Record a timeline of the load to TRACE, in the Chrome trace event\n"
+			  "                 format (only in builds with SSV_ENABLE_TRACING)\n"
+			  "  --memory-budget=MB\n"
+			  "                 Keep as little of the save in memory as possible, and give up if the\n"
+			  "                 input and the parse tree together would need more than MB megabytes\n"
+			  "  --lazy         Only parse the parts of the save that are needed, when they are needed\n"
+			  "  --recover      Skip over the parts of the save that can't be parsed, with a warning for\n"
+			  "                 each, instead of giving up\n", argv0);
+}
+
+static void printBudgetExceeded(const char *fileArg, const Parser &parser, qint64 memoryBudget) {
+	fprintf(stderr, "%s:%llu: Parsing needs more than the memory budget of %lld MB (%lld MB in use). "
+			"Try a larger --memory-budget.\n", fileArg, parser.getLatestParserError().erroredToken.line,
+			(long long) memoryBudget >> 20, (long long) parser.memoryInUse() >> 20);
+}
+
+// Warn about the errors that the parser skipped over, from the `first'; returns how many there are.
+static size_t printRecoveredErrors(const char *fileArg, const Parser &parser, size_t first) {
+	const std::vector<ParserError> &errors = parser.getErrors();
+	for (size_t i = first; i < errors.size(); i++) {
+		const ParserError &err = errors[i];
+		fprintf(stderr, "Warning: %s:%llu:%llu: %s Skipped.\n", fileArg, err.erroredToken.line,
+				err.erroredToken.firstChar, Parsing::getErrorDescription(err.etype).toLocal8Bit().constData());
+	}
+	return errors.size();
+}
+
 int frontend_json_begin(int argc, char **argv) {
-	if (argc != 3) {
-		fprintf(stderr, "USAGE: %s --frontend=json <FILE>\n\n"
-				  "  Read the gamestate file FILE and dump json stats to stdout\n", argv[0]);
+	bool compact = false;
+	bool cbor = false;
+	bool printStats = false;
+	const char *traceArg = nullptr;
+	qint64 memoryBudget = -1;
+	bool lazy = false;
+	bool recover = false;
+	const char *fileArg = nullptr;
+	for (int i = 2; i < argc; i++) {
+		if (strcmp(argv[i], "--compact") == 0) {
+			compact = true;
+		} else if (strcmp(argv[i], "--format=json") == 0) {
+			cbor = false;
+		} else if (strcmp(argv[i], "--format=cbor") == 0) {
+			cbor = true;
+		} else if (strcmp(argv[i], "--stats") == 0) {
+			printStats = true;
+		} else if (strncmp(argv[i], "--trace=", 8) == 0) {
+			traceArg = argv[i] + 8;
+		} else if (strncmp(argv[i], "--memory-budget=", 16) == 0) {
+			memoryBudget = atoll(argv[i] + 16) << 20;
+			if (memoryBudget <= 0) {
+				printUsage(argv[0]);
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--lazy") == 0) {
+			lazy = true;
+		} else if (strcmp(argv[i], "--recover") == 0) {
+			recover = true;
+		} else if (strncmp(argv[i], "--", 2) == 0 || fileArg) {
+			printUsage(argv[0]);
+			return 1;
+		} else {
+			fileArg = argv[i];
+		}
+	}
+	if (!fileArg) {
+		printUsage(argv[0]);
 		return 1;
 	}
-	QString filename(argv[2]);
+	Tracing::StopGuard traceGuard;
+	if (traceArg) {
+		if (!Tracing::isAvailable()) {
+			fprintf(stderr, "Warning: this build does not support --trace, ignoring it.\n");
+		} else if (!Tracing::start(QString::fromLocal8Bit(traceArg))) {
+			fprintf(stderr, "Warning: unable to start tracing to %s.\n", traceArg);
+		}
+	} else {
+		Tracing::startFromEnvironment();
+	}
+
+	QString filename(fileArg);
+	LoadStatistics statistics;
+	LoadStatistics *stats = printStats ? &statistics : nullptr;
 	MemBuf *buf;
 	bool isCompressed = filename.endsWith(QStringLiteral(".sav"));
 	QFile f(filename);
 
 	f.open(QIODevice::ReadOnly);
+	statistics.add(LoadStatistics::FileBytes, f.size());
 	if (isCompressed) {
 		unsigned char *content;
 		unsigned long contentSize;
 		fprintf(stderr, "Inflating file ...\n");
-		int result = extractGamestate(f, &content, &contentSize);
+		int result;
+		{
+			ScopedTimer timer(stats, LoadStatistics::Inflate);
+			result = extractGamestate(f, &content, &contentSize);
+		}
 		f.close();
 
 		if (result != 0) {
 			fprintf(stderr, "%s:\n%s\n\nPlease make sure you have selected a valid save file. If the selected file "
 				   "loads fine in the game, please report this issue to the developer.\n",
-				   argv[2], getInflateErrmsg(result).toLocal8Bit().data());
+				   fileArg, getInflateErrmsg(result).toLocal8Bit().data());
 			if (result <= 2) free(content);
 			return 3;
 		}
@@ -63,32 +156,95 @@ int frontend_json_begin(int argc, char **argv) {
 	} else {
 		buf = new MemBuf(f);
 	}
+	statistics.add(LoadStatistics::GamestateBytes, buf->size());
+	if (memoryBudget >= 0 && qint64(buf->size()) > memoryBudget) {
+		fprintf(stderr, "%s: The gamestate takes up %lld MB, more than the memory budget of %lld MB.\n",
+				fileArg, (long long) buf->size() >> 20, (long long) memoryBudget >> 20);
+		return 5;
+	}
 
 	Parser parser(*buf, FileType::SaveFile, filename);
+	parser.setStatistics(stats);
+	if (memoryBudget >= 0) {
+		// Lazy nodes are parsed from the input later on, so it has to stay around in that case.
+		buf->setReleaseInput(!lazy);
+		parser.setSectionFilter(Galaxy::StateFactory::requiredSections());
+		parser.setMemoryBudget(memoryBudget);
+	}
+	parser.setLazy(lazy);
+	parser.setResilient(recover);
 	fprintf(stderr, "Parsing file ...\n");
 	AstNode *node = parser.parse();
 	if (node == nullptr) {
 		ParserError err = parser.getLatestParserError();
+		if (err.etype == PE_MEMORY_BUDGET_EXCEEDED) {
+			printBudgetExceeded(fileArg, parser, memoryBudget);
+			return 5;
+		}
 		fprintf(stderr, "Parser Error on %s:%llu:%llu: Error#%d\n",
-				argv[2], err.erroredToken.line, err.erroredToken.firstChar, err.etype);
+				fileArg, err.erroredToken.line, err.erroredToken.firstChar, err.etype);
 		return 2;
 	} else if (node->countChildren() == 0) {
-		fprintf(stderr, "%s: Unknown parse error.\n", argv[2]);
+		fprintf(stderr, "%s: Unknown parse error.\n", fileArg);
 		return 2;
 	}
 
+	const size_t errorsPrinted = printRecoveredErrors(fileArg, parser, 0);
+
+	// Unless it is lazy, the parser is done with the input, and only the tree is needed from here on.
+	if (!lazy) {
+		delete buf;
+		buf = nullptr;
+	}
+
 	fprintf(stderr, "Building galaxy ...\n");
 	Galaxy::StateFactory sf;
+	sf.setStatistics(stats);
+	if (memoryBudget >= 0) {
+		QObject::connect(&sf, &Galaxy::StateFactory::sectionFinished, [&parser](const AstNode *section) {
+			parser.releaseSection(section);
+		});
+	}
 	Galaxy::State *state = sf.createFromAst(node, nullptr);
+	if (lazy) printRecoveredErrors(fileArg, parser, errorsPrinted);  // from the parts that have only been parsed now
 	if (state == nullptr) {
+		ParserError err = parser.getLatestParserError();
+		if (lazy && err.etype == PE_MEMORY_BUDGET_EXCEEDED) {
+			printBudgetExceeded(fileArg, parser, memoryBudget);
+			return 5;
+		} else if (lazy && err.etype != PE_NONE) {
+			fprintf(stderr, "Parser Error on %s:%llu:%llu: Error#%d\n",
+					fileArg, err.erroredToken.line, err.erroredToken.firstChar, err.etype);
+			return 2;
+		}
 		fprintf(stderr, "Error extracting data from the save file.\n");
 		return 3;
 	}
+	// A lazy parser is done with the input only now.
 	delete buf;
+	buf = nullptr;
 
 	fprintf(stderr, "Extracting data ... ");
-	QJsonObject toplevelObj(createJsonFromState(state));
-	QJsonDocument outdoc(toplevelObj);
-	printf("%s\n", outdoc.toJson().data());
+	QFile out;
+	bool ok = out.open(stdout, QIODevice::WriteOnly);
+	{
+		ScopedTimer timer(stats, LoadStatistics::Serialize);
+		if (ok && cbor) {
+#ifdef Q_OS_WIN
+			// keep the runtime from turning every 0x0a byte into "\r\n"
+			_setmode(_fileno(stdout), _O_BINARY);
+#endif
+			ok = writeCborFromState(&out, state);
+		} else if (ok) {
+			ok = writeJsonFromState(&out, state, compact);
+		}
+	}
+	if (!ok) {
+		fprintf(stderr, "error writing output.\n");
+		return 4;
+	}
+	out.close();
+	fprintf(stderr, "done.\n");
+	if (printStats) fprintf(stderr, "\n%s", statistics.toText().toLocal8Bit().constData());
 	return 0;
 }
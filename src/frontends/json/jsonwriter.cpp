@@ -0,0 +1,160 @@
+/* frontends/json/jsonwriter.cpp: Streaming JSON output.
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jsonwriter.h"
+
+#include <QtCore/QIODevice>
+#include <QtCore/QLocale>
+#include <QtCore/QString>
+#include <QtCore/qnumeric.h>
+
+JsonWriter::JsonWriter(QIODevice *out, bool compact) : out(out), compact(compact) {
+	buffer.reserve(flushThreshold + 1024);
+}
+
+JsonWriter::~JsonWriter() {
+	flush();
+}
+
+bool JsonWriter::flush() {
+	if (!buffer.isEmpty()) {
+		if (out->write(buffer) != buffer.size()) error = true;
+		buffer.clear();
+	}
+	return !error;
+}
+
+bool JsonWriter::hasError() const {
+	return error;
+}
+
+// Start a new line at the current nesting depth (indented output only).
+void JsonWriter::newline() {
+	if (compact) return;
+	put('\n');
+	for (qsizetype i = 0; i < hasMembers.size(); i++) buffer.append("    ", 4);
+}
+
+// Emit whatever needs to go in front of a value: nothing after a key, otherwise a separator.
+void JsonWriter::beginValue() {
+	if (afterKey) {
+		afterKey = false;
+		return;
+	}
+	if (hasMembers.isEmpty()) return;  // top-level value
+	if (hasMembers.last()) put(',');
+	hasMembers.last() = true;
+	newline();
+}
+
+void JsonWriter::beginContainer(char open) {
+	beginValue();
+	put(open);
+	hasMembers.append(false);
+}
+
+void JsonWriter::endContainer(char close) {
+	bool hadMembers = hasMembers.last();
+	hasMembers.removeLast();
+	if (hadMembers) newline();
+	put(close);
+	if (hasMembers.isEmpty() && !compact) put('\n');
+	maybeFlush();
+}
+
+void JsonWriter::beginObject(qsizetype) {
+	beginContainer('{');
+}
+
+void JsonWriter::endObject() {
+	endContainer('}');
+}
+
+void JsonWriter::beginArray(qsizetype) {
+	beginContainer('[');
+}
+
+void JsonWriter::endArray() {
+	endContainer(']');
+}
+
+void JsonWriter::key(const char *name) {
+	beginValue();
+	writeString(QByteArray::fromRawData(name, qstrlen(name)));
+	if (compact) put(':');
+	else buffer.append(": ", 2);
+	afterKey = true;
+}
+
+void JsonWriter::key(const QString &name) {
+	beginValue();
+	writeString(name.toUtf8());
+	if (compact) put(':');
+	else buffer.append(": ", 2);
+	afterKey = true;
+}
+
+void JsonWriter::value(const QString &val) {
+	beginValue();
+	writeString(val.toUtf8());
+	maybeFlush();
+}
+
+void JsonWriter::value(double val) {
+	beginValue();
+	// Same representation QJsonDocument would use.
+	if (qIsFinite(val)) buffer.append(QByteArray::number(val, 'g', QLocale::FloatingPointShortest));
+	else buffer.append("null", 4);
+	maybeFlush();
+}
+
+void JsonWriter::value(qint64 val) {
+	beginValue();
+	buffer.append(QByteArray::number(val));
+	maybeFlush();
+}
+
+// Write a quoted string, escaping as required by RFC 8259. Non-ASCII characters are passed through as UTF-8.
+void JsonWriter::writeString(const QByteArray &utf8) {
+	static const char hexDigits[] = "0123456789abcdef";
+	put('"');
+	const char *begin = utf8.constData();
+	const char *end = begin + utf8.size();
+	const char *run = begin;  // start of the current stretch of characters that need no escaping
+	for (const char *p = begin; p != end; p++) {
+		auto c = static_cast<unsigned char>(*p);
+		if (c >= 0x20 && c != '"' && c != '\\') continue;
+		buffer.append(run, p - run);
+		run = p + 1;
+		put('\\');
+		switch (c) {
+			case '"': put('"'); break;
+			case '\\': put('\\'); break;
+			case '\b': put('b'); break;
+			case '\f': put('f'); break;
+			case '\n': put('n'); break;
+			case '\r': put('r'); break;
+			case '\t': put('t'); break;
+			default:
+				buffer.append("u00", 3);
+				put(hexDigits[c >> 4]);
+				put(hexDigits[c & 0xf]);
+		}
+	}
+	buffer.append(run, end - run);
+	put('"');
+}
@@ -0,0 +1,79 @@
+/* frontends/json/jsonwriter.h: Streaming JSON output (header file)
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#ifndef STELLARIS_STAT_VIEWER_JSONWRITER_H
+#define STELLARIS_STAT_VIEWER_JSONWRITER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVarLengthArray>
+
+class QIODevice;
+class QString;
+
+/** Writes JSON text straight to a device as it is produced, without building a document in memory.
+ *
+ * Output is collected in a small buffer that is handed to the device whenever it fills up, so memory
+ * use does not depend on the size of the output. The caller is responsible for emitting a well-formed
+ * sequence of calls (e.g. a key before each value inside an object).
+ */
+class JsonWriter {
+	Q_DISABLE_COPY(JsonWriter)
+public:
+	/** @param out The device to write to, must already be open for writing.
+	 *  @param compact Omit all optional whitespace instead of indenting like QJsonDocument::Indented. */
+	explicit JsonWriter(QIODevice *out, bool compact = false);
+	~JsonWriter();
+
+	// The sizes are only hints for length-prefixed formats and have no effect on JSON output.
+	void beginObject(qsizetype size = -1);
+	void endObject();
+	void beginArray(qsizetype size = -1);
+	void endArray();
+	/** Write the key of the next object member. */
+	void key(const char *name);
+	void key(const QString &name);
+	void value(const QString &val);
+	void value(double val);
+	void value(qint64 val);
+
+	/** Hand all buffered output to the device. Returns false if any write so far has failed. */
+	bool flush();
+	bool hasError() const;
+
+private:
+	void beginValue();
+	void beginContainer(char open);
+	void endContainer(char close);
+	void newline();
+	void writeString(const QByteArray &utf8);
+	inline void put(char c) { buffer.append(c); }
+	inline void maybeFlush() { if (Q_UNLIKELY(buffer.size() >= flushThreshold)) flush(); }
+
+	static constexpr qsizetype flushThreshold = 64 * 1024;
+
+	QIODevice *out;
+	bool compact;
+	bool error = false;
+	bool afterKey = false;
+	QByteArray buffer;
+	// For every currently open container: whether it already has at least one member.
+	QVarLengthArray<bool, 16> hasMembers;
+};
+
+#endif //STELLARIS_STAT_VIEWER_JSONWRITER_H
@@ -0,0 +1,143 @@
+/* gamestateloader.cpp: Loading save files on a worker thread.
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gamestateloader.h"
+
+#include <memory>
+
+#include <QtCore/QFile>
+#include <QtCore/QThread>
+
+#include "../../core/extract_gamestate.h"
+#include "../../core/galaxy_state.h"
+#include "../../core/parser.h"
+#include "../../core/tracing.h"
+
+GamestateLoader::GamestateLoader(const GameTranslator *translator, QThread *resultThread, QObject *parent)
+		: QObject(parent), translator(translator), resultThread(resultThread) {}
+
+void GamestateLoader::requestCancel() {
+	cancelRequested = true;
+}
+
+void GamestateLoader::load(const QString &fileName) {
+	SSV_TRACE_SCOPE("GamestateLoader::load");
+	cancelRequested = false;
+	lastReported = 0;
+	emit stageChanged(Stage::Loading);
+	emit progress(0, 0);
+
+	LoadStatistics statistics;
+	std::unique_ptr<Parsing::MemBuf> buf;
+	QFile f(fileName);
+	if (!f.open(QIODevice::ReadOnly)) {
+		emit failed(tr("Unable to open file"), tr("%1 could not be opened: %2").arg(fileName, f.errorString()));
+		return;
+	}
+	statistics.add(LoadStatistics::FileBytes, f.size());
+	if (fileName.endsWith(QStringLiteral(".sav"))) {
+		unsigned char *content;  // where the extracted gamestate file will go, if necessary
+		unsigned long contentSize;
+		int result;
+		{
+			ScopedTimer timer(&statistics, LoadStatistics::Inflate);
+			result = extractGamestate(f, &content, &contentSize);
+		}
+		f.close();
+		if (result != 0) {
+			if (result <= 2) free(content);
+			emit failed(tr("Compression Error"), tr("An error occurred while inflating the selected "
+			                                        "file:\n%1\nPlease make sure that you have selected a valid save file. If the selected file loads fine "
+			                                        "in the game, please report this issue "
+			                                        "to the developer.").arg(getInflateErrmsg(result)));
+			return;
+		}
+		buf.reset(new Parsing::MemBuf((char *) content, contentSize));
+	} else {
+		buf.reset(new Parsing::MemBuf(f));
+	}
+	statistics.add(LoadStatistics::GamestateBytes, buf->size());
+	if (cancelRequested) {
+		emit cancelled();
+		return;
+	}
+
+	Parsing::Parser parser(*buf, Parsing::FileType::SaveFile, fileName);
+	parser.setStatistics(&statistics);
+	connect(&parser, &Parsing::Parser::progress, this, &GamestateLoader::parserProgressUpdate, Qt::DirectConnection);
+	Parsing::AstNode *result = parser.parse();
+
+	if (!result) {
+		Parsing::ParserError error(parser.getLatestParserError());
+		if (error.etype == Parsing::PE_CANCELLED) {
+			emit cancelled();
+		} else {
+			emit failed(tr("Parse Error"), tr("%1:%2:%3: %4 (error #%5)").arg(fileName).arg(error.erroredToken.line)
+					.arg(error.erroredToken.firstChar).arg(Parsing::getErrorDescription(error.etype)).arg(error.etype));
+		}
+		return;
+	}
+
+	buf.reset();  // only the tree is needed from here on
+
+	lastReported = 0;
+	emit stageChanged(Stage::Building);
+	emit progress(0, 0);
+	Galaxy::StateFactory stateFactory;
+	stateFactory.setStatistics(&statistics);
+	connect(&stateFactory, &Galaxy::StateFactory::progress, this, &GamestateLoader::galaxyProgressUpdate, Qt::DirectConnection);
+	Galaxy::State *state = stateFactory.createFromAst(result, translator, nullptr);
+	if (!state) {
+		if (cancelRequested) {
+			emit cancelled();
+		} else {
+			emit failed(tr("Galaxy Creation Error"), tr("An error occurred while trying to extract "
+			                                            "information from %1. Perhaps something isn't right with the input file.").arg(fileName));
+		}
+		return;
+	}
+
+	emit stageChanged(Stage::Finishing);
+	// The receiver owns the state from here on; it must live on its thread to be parented there.
+	state->moveToThread(resultThread);
+	emit finished(state, fileName, statistics);
+}
+
+// Both progress handlers run on the worker thread (direct connections), so they can
+// forward a cancel request to the parser or factory without further synchronization.
+void GamestateLoader::parserProgressUpdate(Parsing::Parser *parser, qint64 current, qint64 max) {
+	if (cancelRequested) {
+		parser->cancel();
+		return;
+	}
+	if (shouldReport(current, max)) emit progress(current, max);
+}
+
+void GamestateLoader::galaxyProgressUpdate(Galaxy::StateFactory *factory, int current, int max) {
+	if (cancelRequested) {
+		factory->cancel();
+		return;
+	}
+	if (shouldReport(current, max)) emit progress(current, max);
+}
+
+// Every progress report becomes an event in the GUI thread, so only pass on steps of at least 0.5%.
+bool GamestateLoader::shouldReport(qint64 current, qint64 max) {
+	if (current != max && (current - lastReported) * 200 < max) return false;
+	lastReported = current;
+	return true;
+}
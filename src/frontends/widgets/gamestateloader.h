@@ -0,0 +1,82 @@
+/* gamestateloader.h: Loading save files on a worker thread (header file)
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#ifndef STELLARIS_STAT_VIEWER_GAMESTATELOADER_H
+#define STELLARIS_STAT_VIEWER_GAMESTATELOADER_H
+
+#include <atomic>
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+// needs to be complete so that State pointers can be passed through queued connections
+#include "../../core/galaxy_state.h"
+#include "../../core/instrumentation.h"
+
+class GameTranslator;
+class QThread;
+namespace Parsing { class Parser; }
+
+/** Runs the whole load pipeline (inflate, parse, build the galaxy) for one file at a time.
+ *
+ * The loader is meant to be moved to a worker thread; all communication with it happens through
+ * queued signals, except for requestCancel(), which may be called from any thread.
+ */
+class GamestateLoader : public QObject {
+	Q_OBJECT
+public:
+	enum class Stage {
+		Loading,
+		Building,
+		Finishing
+	};
+	Q_ENUM(Stage)
+
+	/** @param translator Only read from while a load is running.
+	 *  @param resultThread The thread that finished states are handed over to. */
+	GamestateLoader(const GameTranslator *translator, QThread *resultThread, QObject *parent = nullptr);
+	/** Ask the load that is currently running, if any, to stop as soon as possible. */
+	void requestCancel();
+
+public slots:
+	void load(const QString &fileName);
+
+signals:
+	void stageChanged(GamestateLoader::Stage stage);
+	void progress(qint64 current, qint64 max);
+	/** The new state has no parent and has already been moved to the result thread.
+	 *  `statistics' says how long each stage of loading it took. */
+	void finished(Galaxy::State *state, const QString &fileName, const LoadStatistics &statistics);
+	void failed(const QString &title, const QString &message);
+	void cancelled();
+
+private slots:
+	void parserProgressUpdate(Parsing::Parser *parser, qint64 current, qint64 max);
+	void galaxyProgressUpdate(Galaxy::StateFactory *factory, int current, int max);
+
+private:
+	bool shouldReport(qint64 current, qint64 max);
+
+	const GameTranslator *translator;
+	QThread *resultThread;
+	std::atomic<bool> cancelRequested { false };
+	qint64 lastReported = 0;
+};
+
+#endif //STELLARIS_STAT_VIEWER_GAMESTATELOADER_H
@@ -0,0 +1,120 @@
+/* loadstatisticsdialog.cpp: Shows how long each stage of loading the current save took.
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "loadstatisticsdialog.h"
+
+#include <QtCore/QLocale>
+#include <QtGui/QClipboard>
+#include <QtGui/QGuiApplication>
+#include <QtWidgets/QDialogButtonBox>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QTableWidget>
+#include <QtWidgets/QVBoxLayout>
+
+static QTableWidgetItem *numberItem(const QString &text) {
+	QTableWidgetItem *item = new QTableWidgetItem(text);
+	item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+	return item;
+}
+
+LoadStatisticsDialog::LoadStatisticsDialog(const LoadStatistics &statistics, const QString &fileName, QWidget *parent)
+		: QDialog(parent), statistics(statistics) {
+	setWindowTitle(tr("Load Statistics"));
+	QVBoxLayout *mainLayout = new QVBoxLayout;
+	setLayout(mainLayout);
+	const QLocale locale;
+
+	fileLabel = new QLabel(fileName);
+	fileLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+	mainLayout->addWidget(fileLabel);
+
+	phaseTable = new QTableWidget(0, 2);
+	phaseTable->setHorizontalHeaderLabels({ tr("Time (ms)"), tr("Share") });
+	const qint64 total = statistics.totalTime();
+	QStringList phaseLabels;
+	for (int i = 0; i < LoadStatistics::PhaseCount; i++) {
+		const LoadStatistics::Phase phase = LoadStatistics::Phase(i);
+		const qint64 time = statistics.time(phase);
+		if (!time) continue;
+		const int row = phaseTable->rowCount();
+		phaseTable->insertRow(row);
+		phaseLabels.append(phaseLabel(phase));
+		phaseTable->setItem(row, 0, numberItem(locale.toString(time / 1e6, 'f', 1)));
+		phaseTable->setItem(row, 1, numberItem(locale.toString(100.0 * time / total, 'f', 1) + QLatin1Char('%')));
+	}
+	phaseTable->insertRow(phaseTable->rowCount());
+	phaseLabels.append(tr("Total"));
+	phaseTable->setItem(phaseTable->rowCount() - 1, 0, numberItem(locale.toString(total / 1e6, 'f', 1)));
+	phaseTable->setVerticalHeaderLabels(phaseLabels);
+
+	counterTable = new QTableWidget(LoadStatistics::CounterCount, 1);
+	counterTable->setHorizontalHeaderLabels({ tr("Amount") });
+	QStringList counterLabels;
+	for (int i = 0; i < LoadStatistics::CounterCount; i++) {
+		const LoadStatistics::Counter counter = LoadStatistics::Counter(i);
+		counterLabels.append(counterLabel(counter));
+		counterTable->setItem(i, 0, numberItem(locale.toString(statistics.value(counter))));
+	}
+	counterTable->setVerticalHeaderLabels(counterLabels);
+
+	for (QTableWidget *table : { phaseTable, counterTable }) {
+		table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+		table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+		mainLayout->addWidget(table);
+	}
+
+	buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+	QPushButton *copyButton = buttonBox->addButton(tr("Copy"), QDialogButtonBox::ActionRole);
+	copyButton->setToolTip(tr("Copy these statistics as text, e.g. to include them in a bug report."));
+	connect(copyButton, &QPushButton::clicked, this, &LoadStatisticsDialog::copyClicked);
+	connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+	mainLayout->addWidget(buttonBox);
+}
+
+void LoadStatisticsDialog::copyClicked() {
+	QGuiApplication::clipboard()->setText(fileLabel->text() + QLatin1Char('\n') + statistics.toText());
+}
+
+QString LoadStatisticsDialog::phaseLabel(LoadStatistics::Phase phase) {
+	switch (phase) {
+		case LoadStatistics::Inflate: return tr("Inflating");
+		case LoadStatistics::Lex: return tr("Lexing");
+		case LoadStatistics::Parse: return tr("Parsing");
+		case LoadStatistics::BuildEmpires: return tr("Reading empires");
+		case LoadStatistics::BuildFleets: return tr("Reading fleets");
+		case LoadStatistics::BuildShipDesigns: return tr("Reading ship designs");
+		case LoadStatistics::BuildShips: return tr("Reading ships");
+		case LoadStatistics::Aggregates: return tr("Computing totals");
+		case LoadStatistics::Serialize: return tr("Exporting");
+		case LoadStatistics::PhaseCount: break;
+	}
+	return QString::fromLatin1(LoadStatistics::phaseName(phase));
+}
+
+QString LoadStatisticsDialog::counterLabel(LoadStatistics::Counter counter) {
+	switch (counter) {
+		case LoadStatistics::FileBytes: return tr("File size (bytes)");
+		case LoadStatistics::GamestateBytes: return tr("Gamestate size (bytes)");
+		case LoadStatistics::Tokens: return tr("Tokens");
+		case LoadStatistics::Nodes: return tr("Parse tree nodes");
+		case LoadStatistics::ArenaBlocks: return tr("Node blocks");
+		case LoadStatistics::CounterCount: break;
+	}
+	return QString::fromLatin1(LoadStatistics::counterName(counter));
+}
@@ -0,0 +1,47 @@
+/* loadstatisticsdialog.h: Shows how long each stage of loading the current save took.
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#ifndef STELLARIS_STAT_VIEWER_LOADSTATISTICSDIALOG_H
+#define STELLARIS_STAT_VIEWER_LOADSTATISTICSDIALOG_H
+
+#include <QtWidgets/QDialog>
+
+#include "../../core/instrumentation.h"
+class QDialogButtonBox;
+class QLabel;
+class QTableWidget;
+
+class LoadStatisticsDialog : public QDialog {
+	Q_OBJECT
+public:
+	LoadStatisticsDialog(const LoadStatistics &statistics, const QString &fileName, QWidget *parent = nullptr);
+private slots:
+	void copyClicked();
+private:
+	static QString phaseLabel(LoadStatistics::Phase phase);
+	static QString counterLabel(LoadStatistics::Counter counter);
+
+	LoadStatistics statistics;
+	QDialogButtonBox *buttonBox;
+	QLabel *fileLabel;
+	QTableWidget *phaseTable;
+	QTableWidget *counterTable;
+};
+
+#endif //STELLARIS_STAT_VIEWER_LOADSTATISTICSDIALOG_H
@@ -21,16 +21,16 @@
 #define SSV_VERSION "<unknown>"
 #endif
 
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
 #include <QtCore/QFileSystemWatcher>
-#include <QtCore/QJsonArray>
-#include <QtCore/QJsonDocument>
-#include <QtCore/QJsonObject>
 #include <QtCore/QMimeData>
 #include <QtCore/QSettings>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QTextStream>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
 #include <QtGui/QDesktopServices>
 #include <QtGui/QDragEnterEvent>
 #include <QtWidgets/QApplication>
@@ -45,8 +45,9 @@
 #include "../../core/gametranslator.h"
 #include "../../core/galaxy_state.h"
 #include "../../core/empire.h"
-#include "../../core/parser.h"
 #include "../../core/extract_gamestate.h"
+#include "../../core/tracing.h"
+#include "loadstatisticsdialog.h"
 #include "settingsdialog.h"
 #include "techtreedialog.h"
 #include "views/economy_view.h"
@@ -54,8 +55,12 @@
 #include "views/overview_view.h"
 #include "views/research_view.h"
 #include "views/strategic_resources_view.h"
+#include "views/tech_comparison_view.h"
 #include "views/techs_view.h"
 
+// How long, in seconds, to wait for a new save file to be completely written before giving up on it.
+static constexpr qint64 pendingSaveTimeout = 15;
+
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
 	setWindowTitle(tr("Stellaris Stat Viewer"));
 	setAcceptDrops(true);
@@ -70,7 +75,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
 #ifdef SSV_BUILD_JSON
 	exportStatsAction = fileMenu->addAction(tr("Export Data"));
 	exportStatsAction->setEnabled(false);
-	exportStatsAction->setToolTip(tr("Export the currently loaded statistics in JSON format."));
+	exportStatsAction->setToolTip(tr("Export the currently loaded statistics in JSON or CBOR format."));
 	connect(exportStatsAction, &QAction::triggered, this, &MainWindow::exportStatsSelected);
 #endif
 	quitAction = fileMenu->addAction(tr("Exit"));
@@ -79,11 +84,16 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
 	connect(quitAction, &QAction::triggered, this, &MainWindow::quitSelected);
 
 	toolsMenu = theMenuBar->addMenu(tr("Tools"));
+	toolsMenu->setToolTipsVisible(true);
 	techTreeAction = toolsMenu->addAction(tr("Draw Tech Tree..."));
+	loadStatisticsAction = toolsMenu->addAction(tr("Load Statistics..."));
+	loadStatisticsAction->setEnabled(false);
+	loadStatisticsAction->setToolTip(tr("Show how long each stage of loading the current save took."));
 	settingsAction = toolsMenu->addAction(tr("Settings"));
 	settingsAction->setMenuRole(QAction::PreferencesRole);
 	settingsAction->setShortcut(QKeySequence::Preferences);
 	connect(techTreeAction, &QAction::triggered, this, &MainWindow::techTreeSelected);
+	connect(loadStatisticsAction, &QAction::triggered, this, &MainWindow::loadStatisticsSelected);
 	connect(settingsAction, &QAction::triggered, this, &MainWindow::settingsSelected);
 
 	helpMenu = theMenuBar->addMenu(tr("Help"));
@@ -125,11 +135,40 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
 	connect(this, &MainWindow::modelChanged, techView, &TechView::modelChanged);
 	tabs->addTab(techView, tr("Technologies"));
 
+	techComparisonView = new TechComparisonView(translator, this);
+	connect(this, &MainWindow::modelChanged, techComparisonView, &TechComparisonView::modelChanged);
+	tabs->addTab(techComparisonView, tr("Tech Comparison"));
+
 	statusLabel = new QLabel(tr("No file loaded."));
 	statusBar()->addPermanentWidget(statusLabel);
 
 	newSaveWatcher = new QFileSystemWatcher(this);
 	connect(newSaveWatcher, &QFileSystemWatcher::directoryChanged, this, &MainWindow::saveDirModified);
+	connect(newSaveWatcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::pendingSaveChanged);
+	pendingSaveTimer = new QTimer(this);
+	pendingSaveTimer->setSingleShot(true);
+	pendingSaveTimer->setInterval(500);
+	connect(pendingSaveTimer, &QTimer::timeout, this, &MainWindow::pendingSaveSettled);
+
+	// Save files are loaded on a separate thread so that the current state stays usable in the meantime.
+	loaderThread = new QThread(this);
+	loaderThread->setObjectName(QStringLiteral("Loader"));
+	loader = new GamestateLoader(translator, thread());
+	loader->moveToThread(loaderThread);
+	connect(loaderThread, &QThread::finished, loader, &QObject::deleteLater);
+	connect(this, &MainWindow::loadRequested, loader, &GamestateLoader::load);
+	connect(loader, &GamestateLoader::stageChanged, this, &MainWindow::loaderStageChanged);
+	connect(loader, &GamestateLoader::progress, this, &MainWindow::loaderProgress);
+	connect(loader, &GamestateLoader::finished, this, &MainWindow::loaderFinished);
+	connect(loader, &GamestateLoader::failed, this, &MainWindow::loaderFailed);
+	connect(loader, &GamestateLoader::cancelled, this, &MainWindow::loaderCancelled);
+	loaderThread->start();
+}
+
+MainWindow::~MainWindow() {
+	loader->requestCancel();
+	loaderThread->quit();
+	loaderThread->wait();
 }
 
 void MainWindow::aboutQtSelected() {
@@ -168,19 +207,24 @@ void MainWindow::openFileSelected() {
 #include "../json/dataextraction.h"
 
 void MainWindow::exportStatsSelected() {
+	const QString jsonFilter = tr("JSON files (*.json)");
+	const QString cborFilter = tr("CBOR files (*.cbor)");
+	QString selectedFilter;
 	QString saveTo = QFileDialog::getSaveFileName(this, tr("Select target location"), QString(),
-	                                              tr("JSON files (*.json)"));
+	                                              jsonFilter + ";;" + cborFilter, &selectedFilter);
 	if (saveTo == "") {
 		return;
 	}
+	bool asCbor = selectedFilter == cborFilter || saveTo.endsWith(QStringLiteral(".cbor"), Qt::CaseInsensitive);
 
-	QJsonObject result = createJsonFromState(state);
 	// Allow overwriting exisiting files -- a "file exists" query should already be provided
 	// by the OS's "save file" dialog.
 	if (QFile::exists(saveTo)) QFile::remove(saveTo);
 
 	QFile out(saveTo);
-	if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) {
+	QIODevice::OpenMode mode = QIODevice::WriteOnly;
+	if (!asCbor) mode |= QIODevice::Text;
+	if (!out.open(mode)) {
 		QMessageBox message(this);
 		message.setText(tr("Unable to open export file"));
 		message.setInformativeText(tr("I can think of several potential reasons for this, "
@@ -190,10 +234,10 @@ void MainWindow::exportStatsSelected() {
 		message.exec();
 		return;
 	}
-	qint64 written = out.write(QJsonDocument(result).toJson());
+	bool written = asCbor ? writeCborFromState(&out, state) : writeJsonFromState(&out, state);
 	out.close();
 
-	if (written == -1) {
+	if (!written) {
 		QMessageBox message(this);
 		message.setText(tr("Unable to write export file"));
 		message.setInformativeText(tr("I can think of several potential reasons for this, "
@@ -219,7 +263,7 @@ void MainWindow::settingsSelected() {
 			int tc = translator->setFolderAndLanguage(settings.value("game/folder").toString(),
 					settings.value("game/language").toString());
 			statusBar()->showMessage(tr("Loaded %1 strings for language %2.").arg(tc).arg(translator->getLanguage()), 5000);
-			// Cause techView to reload translations
+			// Cause the technology views to reload translations
 			if (state) emit modelChanged(state);
 		}
 	}
@@ -238,23 +282,15 @@ void MainWindow::techTreeSelected() {
 		if (selected == QMessageBox::Yes) this->settingsSelected();
 		return;
 	}
-	if (settings.value("tools/dot", QString()).toString() == "") {
-		QMessageBox messageBox;
-		messageBox.setText(tr("Dot utility not found"));
-		messageBox.setInformativeText(tr("The tech tree functionality relies on the <code>dot</code> utility "
-		                                 "from the GraphViz suite, but I was unable to locate it on your system. Would you like to open "
-		                                 "settings and look for it manually right now?"));
-		messageBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
-		messageBox.setDefaultButton(QMessageBox::Yes);
-		messageBox.setIcon(QMessageBox::Warning);
-		int selected = messageBox.exec();
-		if (selected == QMessageBox::Yes) this->settingsSelected();
-		return;
-	}
 	TechTreeDialog ttd(translator, this);
 	ttd.exec();
 }
 
+void MainWindow::loadStatisticsSelected() {
+	LoadStatisticsDialog dialog(loadStatistics, stateFileName, this);
+	dialog.exec();
+}
+
 void MainWindow::dragEnterEvent(QDragEnterEvent *event) {
 	if (event->mimeData()->hasUrls()) event->accept();
 }
@@ -279,61 +315,54 @@ void MainWindow::dropEvent(QDropEvent *event) {
 }
 
 void MainWindow::loadFromFile(const QFileInfo& file) {
-	delete state;
-	gamestateLoadBegin();
-	Parsing::MemBuf *buf;
-	bool isCompressedFile = file.fileName().endsWith(QStringLiteral(".sav"));
-	QFile f(file.absoluteFilePath());
-	f.open(QIODevice::ReadOnly);
-	if (isCompressedFile) {
-		unsigned char *content;  // where the extracted gamestate file will go, if necessary
-		unsigned long contentSize;
-		int result = extractGamestate(f, &content, &contentSize);
-		f.close();
-		if (result != 0) {
-			QMessageBox::critical(this, tr("Compression Error"), tr("An error occurred while inflating the selected "
-			                                                        "file:\n%1\nPlease make sure that you have selected a valid save file. If the selected file loads fine "
-			                                                        "in the game, please report this issue "
-			                                                        "to the developer.").arg(getInflateErrmsg(result)));
-
-			if (result <= 2) free(content);
-			return;
-		}
-		buf = new Parsing::MemBuf((char *) content, contentSize);
-	} else {
-		buf = new Parsing::MemBuf(f);
-	}
-
-	Parsing::Parser parser(*buf, Parsing::FileType::SaveFile, file.absoluteFilePath(), this);
-	connect(&parser, &Parsing::Parser::progress, this, &MainWindow::parserProgressUpdate);
-	Parsing::AstNode *result = parser.parse();
-
-	if (!result) {
-		gamestateLoadDone();
-		Parsing::ParserError error(parser.getLatestParserError());
-		if (error.etype != Parsing::PE_CANCELLED)
-			QMessageBox::critical(this, tr("Parse Error"),
-			                      tr("%1:%2:%3: %4 (error #%5)").arg(file.absoluteFilePath()).arg(error.erroredToken.line)
-					                      .arg(error.erroredToken.firstChar).arg(
-							                      Parsing::getErrorDescription(error.etype)).arg(error.etype));
-		delete buf;
+	if (isLoading) {
+		statusBar()->showMessage(tr("Still busy loading another file."), 5000);
 		return;
 	}
+	isLoading = true;
+	openFileAction->setEnabled(false);
+	settingsAction->setEnabled(false);  // the loader reads from the translator, which the settings may replace
 
-	gamestateLoadSwitch();
-	Galaxy::StateFactory stateFactory;
-	connect(&stateFactory, &Galaxy::StateFactory::progress, this, &MainWindow::galaxyProgressUpdate);
-	state = stateFactory.createFromAst(result, translator, this);
-	if (!state) {
-		gamestateLoadDone();
-		QMessageBox::critical(this, tr("Galaxy Creation Error"), tr("An error occurred while trying to extract "
-		                                                            "information from %1. Perhaps something isn't right with the input file.").arg(file.absoluteFilePath()));
-		return;
+	// Not modal: the previously loaded state remains usable until the new one is ready.
+	currentProgressDialog = new QProgressDialog(tr("(1/3) Loading gamestate file..."), tr("Cancel"), 0, 0, this);
+	currentProgressDialog->setWindowModality(Qt::NonModal);
+	currentProgressDialog->setMinimumDuration(500);
+	connect(currentProgressDialog, &QProgressDialog::canceled, this, [this]() { loader->requestCancel(); });
+	emit loadRequested(file.absoluteFilePath());
+}
+
+void MainWindow::loaderStageChanged(GamestateLoader::Stage stage) {
+	switch (stage) {
+		case GamestateLoader::Stage::Loading:
+			currentProgressDialog->setLabelText(tr("(1/3) Loading gamestate file..."));
+			break;
+		case GamestateLoader::Stage::Building:
+			currentProgressDialog->setLabelText(tr("(2/3) Building Galaxy..."));
+			break;
+		case GamestateLoader::Stage::Finishing:
+			currentProgressDialog->setLabelText(tr("(3/3) Finishing work..."));
+			break;
 	}
+}
+
+void MainWindow::loaderProgress(qint64 current, qint64 max) {
+	if (currentProgressDialog->wasCanceled()) return;
+	currentProgressDialog->setMaximum(max);
+	currentProgressDialog->setValue(current);
+}
 
-	gamestateLoadFinishing();
-	delete buf;
+void MainWindow::loaderFinished(Galaxy::State *newState, const QString &fileName, const LoadStatistics &statistics) {
+	SSV_TRACE_SCOPE("MainWindow::loaderFinished");
+	Galaxy::State *oldState = state;
+	state = newState;
+	state->setParent(this);
 	emit modelChanged(state);
+	delete oldState;  // only now that no view refers to it anymore
+
+	QFileInfo file(fileName);
+	stateFileName = file.absoluteFilePath();
+	loadStatistics = statistics;
+	loadStatisticsAction->setEnabled(true);
 	statusLabel->setText(state->getDate());
 	statusBar()->showMessage(tr("Loaded %1").arg(file.absoluteFilePath()), 5000);
 #ifdef SSV_BUILD_JSON
@@ -341,99 +370,86 @@ void MainWindow::loadFromFile(const QFileInfo& file) {
 #endif
 	QDir theDir(file.absoluteDir());
 	knownSaveFiles = theDir.entryList(QStringList("*.sav"), QDir::Files);
-    newSaveWatcher->removePaths(newSaveWatcher->directories());
+	newSaveWatcher->removePaths(newSaveWatcher->directories());
 	newSaveWatcher->addPath(theDir.canonicalPath());
 	gamestateLoadDone();
 }
 
-void MainWindow::parserProgressUpdate(Parsing::Parser *parser, qint64 current, qint64 max) const {
-	if (currentProgressDialog->wasCanceled()) {
-		parser->cancel();
-		return;
-	}
-	currentProgressDialog->setMaximum(max);
-	currentProgressDialog->setValue(current);
-}
-
-void MainWindow::galaxyProgressUpdate(Galaxy::StateFactory *factory, int current, int max) const {
-	if (currentProgressDialog->wasCanceled()) {
-		factory->cancel();
-		return;
-	}
-	currentProgressDialog->setMaximum(max);
-	currentProgressDialog->setValue(current);
-}
-
-void MainWindow::gamestateLoadBegin() {
-	currentProgressDialog = new QProgressDialog(tr("(1/3) Loading gamestate file..."), tr("Cancel"), 0, 0, this);
-	currentProgressDialog->setWindowModality(Qt::WindowModal);
-	currentProgressDialog->setMinimumDuration(500);
-}
-
-void MainWindow::gamestateLoadSwitch() const {
-	currentProgressDialog->setLabelText(tr("(2/3) Building Galaxy..."));
-	currentProgressDialog->setValue(0);
-	currentProgressDialog->setMaximum(0);
+void MainWindow::loaderFailed(const QString &title, const QString &message) {
+	gamestateLoadDone();
+	QMessageBox::critical(this, title, message);
 }
 
-void MainWindow::gamestateLoadFinishing() const {
-	currentProgressDialog->setLabelText(tr("(3/3) Finishing work..."));
+void MainWindow::loaderCancelled() {
+	gamestateLoadDone();
 }
 
 void MainWindow::gamestateLoadDone() {
 	currentProgressDialog->close();
 	delete currentProgressDialog;
 	currentProgressDialog = nullptr;
-}
-
-bool MainWindow::hackilyWaitOnFile(const QString &file) {
-	QFile theFile(file);
-	unsigned char *tmp;
-	unsigned long size;
-	int result;
-	// Wait until we can open the file
-	// Using ReadWrite here in hope of being denied until Stellaris is done writing.
-	while (!theFile.open(QIODevice::ReadWrite | QIODevice::Append | QIODevice::ExistingOnly)) {
-		QApplication::processEvents();
-		if (QDateTime::currentSecsSinceEpoch() - autoOpeningBegun > 15) return false;
-	}
-	do {
-		QApplication::processEvents();
-		theFile.reset();
-		// Assume that the game has written the save file in full when extraction succeeds.
-		result = extractGamestate(theFile, &tmp, &size);
-		if (result > 2) continue;
-		free(tmp);
-		if (QDateTime::currentSecsSinceEpoch() - autoOpeningBegun > 15) {
-			theFile.close();
-			return false;
-		}
-	} while (result != 0);
-	theFile.close();
-	return true;
+	openFileAction->setEnabled(true);
+	settingsAction->setEnabled(true);
+	isLoading = false;
 }
 
 void MainWindow::saveDirModified(const QString &dir) {
-	if (isOpeningFile) return;
+	if (isOpeningFile || isLoading) return;
 	QSettings settings;
 	if (!settings.value("autoLoadEnabled", true).toBool()) return;
-	isOpeningFile = true;
-	autoOpeningBegun = QDateTime::currentSecsSinceEpoch();
 	QDir theDir(dir);
 	QStringList newSaveFiles(theDir.entryList(QStringList("*.sav"), QDir::Files, QDir::Time));
 	for (auto i: knownSaveFiles) {
 		if (knownSaveFiles.contains(i)) newSaveFiles.removeAll(i);
 	}
-	if (newSaveFiles.empty()) {
-		isOpeningFile = false;
+	if (newSaveFiles.empty()) return;
+
+	// Don't touch the file until the game is done writing it: wait for writes (and, where the
+	// platform reports them, close events) to stop, then check that the ZIP is complete.
+	isOpeningFile = true;
+	autoOpeningBegun = QDateTime::currentSecsSinceEpoch();
+	pendingSaveFile = theDir.absoluteFilePath(newSaveFiles.last());
+	pendingSaveSize = -1;
+	pendingSaveModified = QDateTime();
+	newSaveWatcher->addPath(pendingSaveFile);
+	statusBar()->showMessage(tr("Waiting on %1").arg(newSaveFiles.last()));
+	pendingSaveTimer->start();
+}
+
+void MainWindow::pendingSaveChanged(const QString &file) {
+	if (!isOpeningFile || file != pendingSaveFile) return;
+	// The file is still being written to, so give it another full interval to settle -- unless it's been
+	// changing for too long already, in which case the running interval is left to expire and give up.
+	if (QDateTime::currentSecsSinceEpoch() - autoOpeningBegun > pendingSaveTimeout) return;
+	pendingSaveTimer->start();
+}
+
+void MainWindow::pendingSaveSettled() {
+	QFileInfo info(pendingSaveFile);
+	bool unchanged = info.exists() && info.size() == pendingSaveSize && info.lastModified() == pendingSaveModified;
+	pendingSaveSize = info.size();
+	pendingSaveModified = info.lastModified();
+	if (unchanged) {
+		QFile theFile(pendingSaveFile);
+		if (theFile.open(QIODevice::ReadOnly) && hasCompleteZipDirectory(theFile)) {
+			finishWaitingOnSave(true);
+			return;
+		}
+	}
+	if (QDateTime::currentSecsSinceEpoch() - autoOpeningBegun > pendingSaveTimeout) {
+		finishWaitingOnSave(false);
 		return;
 	}
-	QString theFile(theDir.absoluteFilePath(newSaveFiles.last()));
-	QLabel label(tr("Waiting on %1").arg(newSaveFiles.last()));
-	statusBar()->addWidget(&label);
-	bool success = hackilyWaitOnFile(theFile);
-	statusBar()->removeWidget(&label);
-	if (success) loadFromFile(QFileInfo(theFile));
-	else statusBar()->showMessage(tr("Timed out -- giving up on %1.").arg(newSaveFiles.last()));
+	pendingSaveTimer->start();
+}
+
+void MainWindow::finishWaitingOnSave(bool complete) {
+	pendingSaveTimer->stop();
+	newSaveWatcher->removePath(pendingSaveFile);
 	isOpeningFile = false;
+	QFileInfo file(pendingSaveFile);
+	pendingSaveFile.clear();
+	statusBar()->clearMessage();
+	if (complete) loadFromFile(file);
+	else statusBar()->showMessage(tr("Timed out -- giving up on %1.").arg(file.fileName()));
 }
@@ -20,10 +20,12 @@
 #ifndef STELLARIS_STAT_VIEWER_MAINWINDOW_H
 #define STELLARIS_STAT_VIEWER_MAINWINDOW_H
 
+#include <QtCore/QDateTime>
 #include <QtCore/QFileInfo>
 #include <QtWidgets/QMainWindow>
 
 #include "frontends.h"
+#include "gamestateloader.h"
 
 class QAction;
 class QFileSystemWatcher;
@@ -32,6 +34,8 @@ class QMenu;
 class QMenuBar;
 class QProgressDialog;
 class QTabWidget;
+class QThread;
+class QTimer;
 
 enum class LoadStage;
 class EconomyView;
@@ -40,20 +44,19 @@ class GameTranslator;
 class OverviewView;
 class ResearchView;
 class StrategicResourcesView;
+class TechComparisonView;
 class TechView;
-namespace Galaxy {
-	class State;
-	class StateFactory;
-}
-namespace Parsing { class Parser; }
+namespace Galaxy { class State; }
 
 class MainWindow : public QMainWindow {
 	Q_OBJECT
 public:
 	MainWindow(QWidget *parent = nullptr);
+	~MainWindow() override;
 
 signals:
 	void modelChanged(const Galaxy::State *newModel);
+	void loadRequested(const QString &fileName);
 
 protected:
 	void dragEnterEvent(QDragEnterEvent *event) override;
@@ -67,27 +70,31 @@ private slots:
 	void quitSelected() const;
 	void settingsSelected();
 	void techTreeSelected();
+	void loadStatisticsSelected();
 
 #ifdef SSV_BUILD_JSON
 	void exportStatsSelected();
 #endif
 
-	void parserProgressUpdate(Parsing::Parser *parser, qint64 current, qint64 max) const;
-	void galaxyProgressUpdate(Galaxy::StateFactory *factory, int current, int max) const;
+	void loaderStageChanged(GamestateLoader::Stage stage);
+	void loaderProgress(qint64 current, qint64 max);
+	void loaderFinished(Galaxy::State *newState, const QString &fileName, const LoadStatistics &statistics);
+	void loaderFailed(const QString &title, const QString &message);
+	void loaderCancelled();
 
 	void saveDirModified(const QString &dir);
+	void pendingSaveChanged(const QString &file);
+	void pendingSaveSettled();
 
 private:
-	void gamestateLoadBegin();
-	void gamestateLoadSwitch() const;
-	void gamestateLoadFinishing() const;
 	void gamestateLoadDone();
 	void loadFromFile(const QFileInfo& file);
-	bool hackilyWaitOnFile(const QString &file);
+	void finishWaitingOnSave(bool complete);
 
 	QAction *aboutQtAction;
 	QAction *aboutSsvAction;
 	QAction *checkForUpdatesAction;
+	QAction *loadStatisticsAction;
 	QAction *openFileAction;
 	QAction *quitAction;
 	QAction *settingsAction;
@@ -96,7 +103,7 @@ private:
 	QMenu *fileMenu;
 	QMenu *helpMenu;
 	QMenu *toolsMenu;
-	QProgressDialog *currentProgressDialog;
+	QProgressDialog *currentProgressDialog = nullptr;
 	QTabWidget *tabs;
 
 #ifdef SSV_BUILD_JSON
@@ -104,18 +111,29 @@ private:
 #endif
 	
 	Galaxy::State *state = nullptr;
+	QString stateFileName;
+	LoadStatistics loadStatistics;
 	GameTranslator *translator;
+	GamestateLoader *loader;
+	QThread *loaderThread;
+	bool isLoading = false;
 	EconomyView *economyView;
 	FleetsView *militaryView;
 	OverviewView *powerRatingView;
 	ResearchView* researchView;
 	StrategicResourcesView* strategicResourcesView;
 	TechView *techView;
+	TechComparisonView *techComparisonView;
 
 	QFileSystemWatcher *newSaveWatcher;
 	QStringList knownSaveFiles;
 	bool isOpeningFile = false;
 	qint64 autoOpeningBegun;
+	// A newly appeared save file that the game may still be writing.
+	QString pendingSaveFile;
+	qint64 pendingSaveSize;
+	QDateTime pendingSaveModified;
+	QTimer *pendingSaveTimer;
 };
 
 #endif //STELLARIS_STAT_VIEWER_MAINWINDOW_H
@@ -48,12 +48,6 @@ SettingsDialog::SettingsDialog(QWidget *parent) : QDialog(parent) {
 	connect(gameFolderSelect, &QPushButton::pressed, this, &SettingsDialog::selectGameClicked);
 	connect(gameFolderEdit, &QLineEdit::textChanged, this, &SettingsDialog::gameDirChanged);
 
-	dotProgramEdit = new QLineEdit;
-	dotProgramSelect = new QPushButton(tr("Select"));
-	dotProgramLabel = new QLabel(tr("Dot:"));
-	dotProgramLabel->setBuddy(dotProgramEdit);
-	connect(dotProgramSelect, &QPushButton::pressed, this, &SettingsDialog::selectDotClicked);
-
 	gameLanguage = new QComboBox;
 	gameLanguageLabel = new QLabel(tr("Game Language:"));
 	gameLanguageLabel->setBuddy(gameLanguage);
@@ -65,17 +59,13 @@ SettingsDialog::SettingsDialog(QWidget *parent) : QDialog(parent) {
 	mainLayout->addWidget(gameFolderLabel, 0, 0, 1, 1);
 	mainLayout->addWidget(gameFolderEdit, 0, 1, 1, 3);
 	mainLayout->addWidget(gameFolderSelect, 0, 4, 1, 1);
-	mainLayout->addWidget(dotProgramLabel, 1, 0, 1, 1);
-	mainLayout->addWidget(dotProgramEdit, 1, 1, 1, 3);
-	mainLayout->addWidget(dotProgramSelect, 1, 4, 1, 1);
-	mainLayout->addWidget(gameLanguageLabel, 2, 0, 1, 1);
-	mainLayout->addWidget(gameLanguage, 2, 1, 1, 4);
-	mainLayout->addWidget(autoLoad, 3, 0, 1, 5);
-	mainLayout->addWidget(buttonBox, 4, 2, 1, 2);
+	mainLayout->addWidget(gameLanguageLabel, 1, 0, 1, 1);
+	mainLayout->addWidget(gameLanguage, 1, 1, 1, 4);
+	mainLayout->addWidget(autoLoad, 2, 0, 1, 5);
+	mainLayout->addWidget(buttonBox, 3, 2, 1, 2);
 
 	QSettings settings;
 	gameFolderEdit->setText(settings.value("game/folder", QString()).toString());
-	dotProgramEdit->setText(settings.value("tools/dot", QString()).toString());
 	gameDirChanged();
 	gameLanguage->setCurrentText(settings.value("game/language", tr("(None)")).toString());
 	autoLoad->setChecked(settings.value("autoLoadEnabled", true).toBool());
@@ -93,22 +83,12 @@ void SettingsDialog::gameDirChanged() {
 void SettingsDialog::okClicked() {
 	QSettings settings;
 	settings.setValue("game/folder", gameFolderEdit->text());
-	settings.setValue("tools/dot", dotProgramEdit->text());
+	settings.remove("tools/dot");  // from when tech trees were drawn by GraphViz
 	settings.setValue("game/language", gameLanguage->currentText());
 	settings.setValue("autoLoadEnabled", autoLoad->isChecked());
 	accept();
 }
 
-void SettingsDialog::selectDotClicked() {
-	#ifdef Q_OS_WIN
-	const QString &folder = QFileDialog::getOpenFileName(this, tr("Select Dot executable"), QString(),
-			tr("Execuables (*.exe)"));
-	#else
-	const QString &folder = QFileDialog::getOpenFileName(this, tr("Select Dot executable"));
-	#endif
-	if (folder != "") dotProgramEdit->setText(folder);
-}
-
 void SettingsDialog::selectGameClicked() {
 	const QString &folder = QFileDialog::getExistingDirectory(this, tr("Select Stellaris game folder"));
 	if (folder != "") gameFolderEdit->setText(folder);
@@ -34,15 +34,14 @@ public:
 public slots:
 	void gameDirChanged();
 	void okClicked();
-	void selectDotClicked();
 	void selectGameClicked();
 private:
 	QCheckBox *autoLoad;
 	QComboBox *gameLanguage;
 	QDialogButtonBox *buttonBox;
 	QGridLayout *mainLayout;
-	QLabel *dotProgramLabel, *gameFolderLabel, *gameLanguageLabel;
-	QLineEdit *dotProgramEdit, *gameFolderEdit;
+	QLabel *gameFolderLabel, *gameLanguageLabel;
+	QLineEdit *gameFolderEdit;
 	QPushButton *okButton, *cancelButton;
-	QPushButton *dotProgramSelect, *gameFolderSelect;
+	QPushButton *gameFolderSelect;
 };
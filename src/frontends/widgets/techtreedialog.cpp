@@ -17,12 +17,14 @@
 
 #include "techtreedialog.h"
 
-#include <QtCore/QDirIterator>
 #include <QtCore/QFileInfo>
-#include <QtCore/QProcess>
 #include <QtCore/QSettings>
-#include <QtCore/QTemporaryDir>
 #include <QtGui/QDesktopServices>
+#include <QtGui/QFontMetricsF>
+#include <QtGui/QPageSize>
+#include <QtGui/QPainter>
+#include <QtGui/QPainterPath>
+#include <QtGui/QPdfWriter>
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QBoxLayout>
 #include <QtWidgets/QDialogButtonBox>
@@ -71,22 +73,88 @@ TechTreeDialog::TechTreeDialog(GameTranslator *translator, QWidget *parent)
 	connect(goButton, &QPushButton::pressed, this, &TechTreeDialog::goClicked);
 	connect(closeButton, &QPushButton::pressed, this, &QDialog::accept);
 	mainLayout->addWidget(buttons, 2, 0);
+
+	connect(&techFilesWatcher, &QFutureWatcher<QVector<Galaxy::Technology *>>::progressValueChanged, this, &TechTreeDialog::techFileRead);
+	connect(&techFilesWatcher, &QFutureWatcher<QVector<Galaxy::Technology *>>::finished, this, &TechTreeDialog::techFilesRead);
+}
+
+TechTreeDialog::~TechTreeDialog() {
+	// The workers are quick to finish each file, so rather than cancelling (and losing track of
+	// technologies already created), let them finish and throw the results away.
+	if (techFilesWatcher.isRunning()) {
+		techFilesWatcher.waitForFinished();
+		for (const auto &fileTechs : techFilesWatcher.future().results()) qDeleteAll(fileTechs);
+	}
+}
+
+static const qreal nodePadding = 4;
+static const qreal pageMargin = 18;
+static const qreal arrowSize = 6;
+
+static QColor areaColor(Galaxy::TechArea area) {
+	switch (area) {
+	case Galaxy::TechArea::Physics:
+		return QColor("blue");
+	case Galaxy::TechArea::Society:
+		return QColor("forestgreen");
+	case Galaxy::TechArea::Engineering:
+		return QColor("orange");
+	}
+	return QColor("black");
+}
+
+static void paintTechTree(QPainter &painter, const TechTreeLayout &layout) {
+	painter.setRenderHint(QPainter::Antialiasing);
+	for (const TechTreeLayout::Edge &edge : layout.edges) {
+		QPen pen(QColor("black"));
+		if (edge.kind != TechTreeLayout::EdgeKind::Requirement) {
+			pen.setStyle(Qt::DashLine);
+			pen.setColor(QColor(edge.kind == TechTreeLayout::EdgeKind::WeightDecrease ? "red" : "forestgreen"));
+		}
+		painter.setPen(pen);
+		painter.setBrush(Qt::NoBrush);
+		// Each leg leaves and arrives horizontally, like the arrows between the columns.
+		QPainterPath path(edge.points.first());
+		for (int i = 1; i < edge.points.size(); i++) {
+			const QPointF &from = edge.points[i - 1], &to = edge.points[i];
+			const qreal middle = (from.x() + to.x()) / 2;
+			path.cubicTo(QPointF(middle, from.y()), QPointF(middle, to.y()), to);
+		}
+		painter.drawPath(path);
+
+		const QPointF &tip = edge.points.last();
+		const qreal direction = tip.x() >= edge.points[edge.points.size() - 2].x() ? 1 : -1;
+		const QPointF head[] = {
+				tip,
+				tip - QPointF(direction * arrowSize, arrowSize / 2),
+				tip - QPointF(direction * arrowSize, -arrowSize / 2)
+		};
+		painter.setPen(Qt::NoPen);
+		painter.setBrush(pen.color());
+		painter.drawPolygon(head, 3);
+	}
+
+	for (const TechTreeLayout::Node &node : layout.nodes) {
+		QColor fill("white");
+		if (node.tech->getIsStartingTech()) {
+			fill = QColor("limegreen");
+		} else if (node.tech->getIsWeightZero()) {
+			fill = QColor("gray");
+		} else if (node.tech->getIsRare()) {
+			fill = QColor("darkorchid");
+		}
+		painter.setPen(QPen(areaColor(node.tech->getArea()), 1.5));
+		painter.setBrush(fill);
+		painter.drawRect(node.rect);
+		painter.setPen(QColor("black"));
+		painter.drawText(node.rect, Qt::AlignCenter, node.label);
+	}
 }
 
 #define UPDATE_STATUS(text) do { statusLabel->setText((text)); update(); QApplication::processEvents(); } while (0)
 
 void TechTreeDialog::goClicked() {
-	QTemporaryDir dir;
-	if (!dir.isValid()) {
-		QMessageBox message(this);
-		message.setText(tr("Unable to create temporary directory"));
-		message.setInformativeText(tr("I can think of several potential reasons for this, "
-			"but perhaps the most likely one is that your system has run out of disk space."));
-		message.setIcon(QMessageBox::Critical);
-		message.setStandardButtons(QMessageBox::Ok);
-		message.exec();
-		return;
-	}
+	if (techFilesWatcher.isRunning()) return;
 	QSettings settings;
 	QDir techDir(settings.value("game/folder").toString() + "/common/technology");
 	// TODO: Error handling for wrong selected folder
@@ -103,63 +171,68 @@ void TechTreeDialog::goClicked() {
 		return;
 	}
 
-	QDirIterator it(techDir.absolutePath(), QStringList("*.txt"), QDir::Files);
-	if (!it.hasNext()) {
+	techFiles = techDir.entryInfoList(QStringList("*.txt"), QDir::Files, QDir::Name);
+	if (techFiles.isEmpty()) {
 		statusLabel->setText(tr("No technologies found."));
 		return;
 	}
+	if (!techCache) techCache.reset(new Galaxy::TechCache);
+	// Every file that isn't cached gets its own parser on the global thread pool; see techFilesRead() for the rest.
+	goButton->setEnabled(false);
+	statusLabel->setText(tr("Reading technologies (0/%1)").arg(techFiles.size()));
+	techFilesWatcher.setFuture(readTechFiles(techFiles, thread(), techCache.get()));
+}
+
+void TechTreeDialog::techFileRead(int filesDone) {
+	statusLabel->setText(tr("Reading technologies (%1/%2)").arg(filesDone).arg(techFiles.size()));
+}
+
+void TechTreeDialog::techFilesRead() {
+	goButton->setEnabled(true);
 	Galaxy::Model model;
-	while (it.hasNext()) {
-		QFileInfo f(it.next());
-		UPDATE_STATUS(tr("Reading %1").arg(f.fileName()));
-		readAnotherTechFile(f, model);
-	}
-	UPDATE_STATUS(tr("Writing nodes"));
-	const QMap<QString, Galaxy::Technology *> &techs = model.getTechnologies();
-	QFile outfile(dir.filePath("techs.dot"));
-	if (!outfile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-		QMessageBox message(this);
-		message.setText(tr("Unable to write tech tree"));
-		message.setInformativeText(tr("I can think of several potential reasons for this, "
-			"but perhaps the most likely one is that your system has run out of disk space."));
-		message.setIcon(QMessageBox::Critical);
-		message.setStandardButtons(QMessageBox::Ok);
-		message.exec();
+	adoptTechFiles(techFiles, techFilesWatcher.future().results(), &model, techCache.get());
+
+	QString saveTo = QFileDialog::getSaveFileName(this, tr("Select target location"), QString(),
+			tr("Portable Document Format (*.pdf)"));
+	if (saveTo == "") {
+		UPDATE_STATUS(tr("Cancelled"));
 		return;
 	}
-	writeTechTreePreamble(&outfile);
-	writeTechTreeNodes(&outfile, techs, translator);
-	UPDATE_STATUS(tr("Writing connections"));
-	writeTechTreeRelations(&outfile, techs, treeCompleteRadio->isChecked());
-	writeTechTreeClosing(&outfile);
-	outfile.close();
-	UPDATE_STATUS(tr("Running dot"));
-	QProcess dot(this);
-	dot.setWorkingDirectory(dir.path());
-	QStringList args;
-	args << "techs.dot" << "-Tpdf" << "-otechs.pdf";
-	dot.start(settings.value("tools/dot").toString(), args);
-	dot.waitForFinished();
-	if (dot.exitStatus() == QProcess::CrashExit || dot.exitCode() != 0) {
+
+	UPDATE_STATUS(tr("Laying out technologies"));
+	// An existing file is simply overwritten -- a "file exists" query should be provided by the
+	// OS's "save file" dialog.
+	QPdfWriter writer(saveTo);
+	writer.setResolution(72);  // so that one unit of the layout is one point
+	writer.setTitle(tr("Tech Tree"));
+	QFont font;
+	font.setPointSizeF(10);
+	const QFontMetricsF metrics(font, &writer);
+	const TechTreeLayout layout = layoutTechTree(model.getTechnologies(), treeCompleteRadio->isChecked(), translator,
+			[&metrics](const QString &label) {
+		return QSizeF(metrics.horizontalAdvance(label) + 2 * nodePadding, metrics.height() + 2 * nodePadding);
+	});
+
+	UPDATE_STATUS(tr("Drawing technologies"));
+	writer.setPageSize(QPageSize(layout.size + QSizeF(2 * pageMargin, 2 * pageMargin), QPageSize::Point,
+			QString(), QPageSize::ExactMatch));
+	writer.setPageMargins(QMarginsF());
+	QPainter painter;
+	if (!painter.begin(&writer)) {
 		QMessageBox message(this);
-		message.setText(tr("Error drawing graph"));
-		message.setInformativeText(tr("Some error occurred, and the <code>dot</code> utility did not finish successfully."));
+		message.setText(tr("Unable to write tech tree"));
+		message.setInformativeText(tr("I was unable to write to %1. Perhaps you do not have permission "
+			"to write there, or your system has run out of disk space.").arg(saveTo));
 		message.setIcon(QMessageBox::Critical);
 		message.setStandardButtons(QMessageBox::Ok);
 		message.exec();
+		UPDATE_STATUS(tr("Ready."));
 		return;
-	} else {
-		QString saveTo = QFileDialog::getSaveFileName(this, tr("Select target location"), QString(),
-				tr("Portable Document Format (*.pdf)"));
-		if (saveTo == "") {
-			UPDATE_STATUS(tr("Cancelled"));
-			return;
-		}
-		// Allow overwriting exisiting files -- a "file exists" query should be provided
-		// by the OS's "save file" dialog.
-		if (QFile::exists(saveTo)) QFile::remove(saveTo);
-		QFile::copy(dir.filePath("techs.pdf"), saveTo);
-		QDesktopServices::openUrl(QUrl::fromLocalFile(saveTo));
 	}
+	painter.setFont(font);
+	painter.translate(pageMargin, pageMargin);
+	paintTechTree(painter, layout);
+	painter.end();
+	QDesktopServices::openUrl(QUrl::fromLocalFile(saveTo));
 	UPDATE_STATUS(tr("Ready."));
-}
\ No newline at end of file
+}
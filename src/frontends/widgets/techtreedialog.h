@@ -20,6 +20,11 @@
 #ifndef STELLARIS_STAT_VIEWER_TECHTREEDIALOG_H
 #define STELLARIS_STAT_VIEWER_TECHTREEDIALOG_H
 
+#include <memory>
+
+#include <QtCore/QDir>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QVector>
 #include <QtWidgets/QDialog>
 class QDialogButtonBox;
 class QGridLayout;
@@ -31,14 +36,21 @@ class QPushButton;
 class QRadioButton;
 
 class GameTranslator;
+namespace Galaxy {
+	class TechCache;
+	class Technology;
+}
 
 class TechTreeDialog : public QDialog {
 	Q_OBJECT
 public:
 	TechTreeDialog(GameTranslator *translator, QWidget *parent = nullptr);
+	~TechTreeDialog() override;
 
 private slots:
 	void goClicked();
+	void techFileRead(int filesDone);
+	void techFilesRead();
 private:
 	QDialogButtonBox *buttons;
 	QGridLayout *mainLayout;
@@ -49,6 +61,9 @@ private:
 	QRadioButton *treeCompleteRadio, *treeReducedRadio;
 
 	GameTranslator *translator;
+	std::unique_ptr<Galaxy::TechCache> techCache;
+	QFileInfoList techFiles;
+	QFutureWatcher<QVector<Galaxy::Technology *>> techFilesWatcher;
 };
 
 #endif //STELLARIS_STAT_VIEWER_TECHTREEDIALOG_H
\ No newline at end of file
@@ -20,16 +20,12 @@
 #ifndef STELLARIS_STAT_VIEWER_ECONOMY_VIEW_H
 #define STELLARIS_STAT_VIEWER_ECONOMY_VIEW_H
 
-#include <QtWidgets/QTableWidget>
+#include "empire_table_view.h"
 
-namespace Galaxy { class State; }
-
-class EconomyView : public QTableWidget {
+class EconomyView : public EmpireTableView {
 	Q_OBJECT
 public:
 	EconomyView(QWidget *parent = nullptr);
-public slots:
-	void modelChanged(const Galaxy::State *newState);
 };
 
 #endif //STELLARIS_STAT_VIEWER_ECONOMY_VIEW_H
\ No newline at end of file
@@ -0,0 +1,84 @@
+/* empire_table_view.cpp: Sortable per-empire tables backed directly by the galaxy state.
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "empire_table_view.h"
+
+#include <QtCore/QSortFilterProxyModel>
+#include <QtWidgets/QHeaderView>
+
+#include "../../../core/empire.h"
+#include "../../../core/galaxy_state.h"
+#include "../../../core/tracing.h"
+
+EmpireTableModel::EmpireTableModel(QVector<Column> columns, RowFilter filter, QObject *parent)
+		: QAbstractTableModel(parent), columns(std::move(columns)), filter(std::move(filter)) {}
+
+void EmpireTableModel::setState(const Galaxy::State *newState) {
+	beginResetModel();
+	state = newState;
+	rows.clear();
+	if (state) {
+		const QMap<qint64, Galaxy::Empire *> &empires = state->getEmpires();
+		rows.reserve(empires.size());
+		for (auto it = empires.cbegin(); it != empires.cend(); it++) {
+			if (!filter || filter(state, it.value())) rows.append(it.value());
+		}
+	}
+	endResetModel();
+}
+
+void EmpireTableModel::columnChanged(int column) {
+	if (rows.isEmpty()) return;
+	emit dataChanged(index(0, column), index(rows.size() - 1, column), { Qt::DisplayRole, SortRole });
+}
+
+int EmpireTableModel::rowCount(const QModelIndex &parent) const {
+	return parent.isValid() ? 0 : rows.size();
+}
+
+int EmpireTableModel::columnCount(const QModelIndex &parent) const {
+	return parent.isValid() ? 0 : columns.size();
+}
+
+QVariant EmpireTableModel::data(const QModelIndex &index, int role) const {
+	if (!index.isValid() || (role != Qt::DisplayRole && role != SortRole)) return QVariant();
+	return columns[index.column()].value(state, rows[index.row()]);
+}
+
+QVariant EmpireTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+	if (role != Qt::DisplayRole) return QVariant();
+	if (orientation == Qt::Vertical) return section + 1;
+	return columns[section].header;
+}
+
+EmpireTableView::EmpireTableView(QVector<EmpireTableModel::Column> columns, EmpireTableModel::RowFilter filter, QWidget *parent)
+		: QTableView(parent) {
+	tableModel = new EmpireTableModel(std::move(columns), std::move(filter), this);
+	proxyModel = new QSortFilterProxyModel(this);
+	proxyModel->setSourceModel(tableModel);
+	proxyModel->setSortRole(EmpireTableModel::SortRole);
+	setModel(proxyModel);
+	setSortingEnabled(true);
+	sortByColumn(-1, Qt::AscendingOrder);  // keep the state's order until a header is clicked
+	setSelectionBehavior(QAbstractItemView::SelectRows);
+	setEditTriggers(QAbstractItemView::NoEditTriggers);
+}
+
+void EmpireTableView::modelChanged(const Galaxy::State *newState) {
+	SSV_TRACE_SCOPE("EmpireTableView::modelChanged");
+	tableModel->setState(newState);
+}
@@ -0,0 +1,84 @@
+/* empire_table_view.h: Sortable per-empire tables backed directly by the galaxy state.
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#ifndef STELLARIS_STAT_VIEWER_EMPIRE_TABLE_VIEW_H
+#define STELLARIS_STAT_VIEWER_EMPIRE_TABLE_VIEW_H
+
+#include <functional>
+
+#include <QtCore/QAbstractTableModel>
+#include <QtCore/QVector>
+#include <QtWidgets/QTableView>
+
+class QSortFilterProxyModel;
+
+namespace Galaxy {
+	class Empire;
+	class State;
+}
+
+/** A table model with one row per empire, whose cells are computed from the state on demand.
+ *
+ * Numeric columns hand out their raw numbers (for both display and SortRole) rather than
+ * formatted strings, so sorting never has to parse any text.
+ */
+class EmpireTableModel : public QAbstractTableModel {
+	Q_OBJECT
+public:
+	static constexpr int SortRole = Qt::UserRole;
+
+	struct Column {
+		QString header;
+		std::function<QVariant(const Galaxy::State *, const Galaxy::Empire *)> value;
+	};
+	using RowFilter = std::function<bool(const Galaxy::State *, const Galaxy::Empire *)>;
+
+	EmpireTableModel(QVector<Column> columns, RowFilter filter = RowFilter(), QObject *parent = nullptr);
+	void setState(const Galaxy::State *newState);
+	/** Announce that the values of the given column have changed, e.g. because of a display option. */
+	void columnChanged(int column);
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+	QVector<Column> columns;
+	RowFilter filter;
+	const Galaxy::State *state = nullptr;
+	QVector<const Galaxy::Empire *> rows;
+};
+
+/** Common base for the tabular views: an EmpireTableModel behind a sorting proxy. */
+class EmpireTableView : public QTableView {
+	Q_OBJECT
+public:
+	EmpireTableView(QVector<EmpireTableModel::Column> columns, EmpireTableModel::RowFilter filter = EmpireTableModel::RowFilter(),
+	                QWidget *parent = nullptr);
+
+public slots:
+	void modelChanged(const Galaxy::State *newState);
+
+protected:
+	EmpireTableModel *tableModel;
+	QSortFilterProxyModel *proxyModel;
+};
+
+#endif //STELLARIS_STAT_VIEWER_EMPIRE_TABLE_VIEW_H
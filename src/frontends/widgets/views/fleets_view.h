@@ -42,8 +42,6 @@ private:
 	FleetsViewInternal *view;
 	QCheckBox *includeStations;
 	QVBoxLayout *layout;
-
-	const Galaxy::State *currentState;
 };
 
 #endif
\ No newline at end of file
@@ -19,35 +19,15 @@
 
 #include "../../../core/galaxy_state.h"
 #include "../../../core/empire.h"
-#include "../numerictableitem.h"
 
-OverviewView::OverviewView(QWidget *parent) : QTableWidget(parent) {
-	setColumnCount(5);
-	QStringList headers;
-	headers << tr("Name")<< tr("Military") << tr("Economy") << tr("Technology") << tr("Systems owned");
-	setHorizontalHeaderLabels(headers);
-}
+OverviewView::OverviewView(QWidget *parent) : EmpireTableView({
+		{ tr("Name"), [](const Galaxy::State *, const Galaxy::Empire *e) { return QVariant(e->getName()); } },
+		{ tr("Military"), [](const Galaxy::State *, const Galaxy::Empire *e) { return QVariant(e->getMilitaryPower()); } },
+		{ tr("Economy"), [](const Galaxy::State *, const Galaxy::Empire *e) { return QVariant(e->getEconomyPower()); } },
+		{ tr("Technology"), [](const Galaxy::State *, const Galaxy::Empire *e) { return QVariant(e->getTechPower()); } },
+		{ tr("Systems owned"), [](const Galaxy::State *s, const Galaxy::Empire *e) { return QVariant((qint64) s->getAggregates(e).ownedSystems); } }
+	}, EmpireTableModel::RowFilter(), parent) {}
 
 QSize OverviewView::sizeHint() const {
 	return { 850, 650 };
 }
-
-void OverviewView::modelChanged(const Galaxy::State *newState) {
-	setSortingEnabled(false);
-	setRowCount(newState->getEmpires().size());
-	const QMap<qint64, Galaxy::Empire*> &empires = newState->getEmpires();
-	int i = 0;
-	for (auto it = empires.cbegin(); it != empires.cend(); it++) {
-		QTableWidgetItem *itemName = new QTableWidgetItem(it.value()->getName());
-		setItem(i, 0, itemName);
-		NumericTableItem *itemMilitary = new NumericTableItem(it.value()->getMilitaryPower());
-		setItem(i, 1, itemMilitary);
-		NumericTableItem *itemEconomy = new NumericTableItem(it.value()->getEconomyPower());
-		setItem(i, 2, itemEconomy);
-		NumericTableItem *itemTechnology = new NumericTableItem(it.value()->getTechPower());
-		setItem(i, 3, itemTechnology);
-		NumericTableItem *itemSystems = new NumericTableItem((qint64) it.value()->getOwnedSystemsCount());
-		setItem(i++, 4, itemSystems);
-	}
-	setSortingEnabled(true);
-}
@@ -20,18 +20,13 @@
 #ifndef STELLARIS_STAT_VIEWER_POWERRATING_VIEW_H
 #define STELLARIS_STAT_VIEWER_POWERRATING_VIEW_H
 
-#include <QtWidgets/QTableWidget>
+#include "empire_table_view.h"
 
-namespace Galaxy { class State; }
-
-class OverviewView : public QTableWidget {
+class OverviewView : public EmpireTableView {
 	Q_OBJECT
 public:
 	OverviewView(QWidget *parent = nullptr);
 	QSize sizeHint() const override;
-
-public slots:
-	void modelChanged(const Galaxy::State *newState);
 };
 
 #endif //STELLARIS_STAT_VIEWER_POWERRATING_VIEW_H
@@ -19,32 +19,12 @@
 
 #include "../../../core/empire.h"
 #include "../../../core/galaxy_state.h"
-#include "../numerictableitem.h"
 
-ResearchView::ResearchView(QWidget* parent) : QTableWidget(parent) {
-	setColumnCount(4);
-	QStringList headers;
-	headers << tr("Name") << tr("Physics") << tr("Society") << tr("Engineering");
-	setHorizontalHeaderLabels(headers);
-}
-
-void ResearchView::modelChanged(const Galaxy::State* newState) {
-	setSortingEnabled(false);
-	const QMap<qint64, Galaxy::Empire*>& empires = newState->getEmpires();
-	setRowCount(empires.size());
-	int i = 0;
-	for (auto it = empires.cbegin(); it != empires.cend(); it++) {
-		Galaxy::Empire* empire = it.value();
-		const QMap<QString, double>& incomes = empire->getIncomes();
-		QTableWidgetItem* nameItem = new QTableWidgetItem(empire->getName());
-		setItem(i, 0, nameItem);
-		NumericTableItem* physicsItem = new NumericTableItem(incomes.value("physics_research", 0.0));
-		setItem(i, 1, physicsItem);
-		NumericTableItem* societyItem = new NumericTableItem(incomes.value("society_research", 0.0));
-		setItem(i, 2, societyItem);
-		NumericTableItem* engineeringItem = new NumericTableItem(incomes.value("engineering_research", 0.0));
-		setItem(i++, 3, engineeringItem);
-	}
-	setRowCount(i);
-	setSortingEnabled(true);
-}
\ No newline at end of file
+ResearchView::ResearchView(QWidget *parent) : EmpireTableView({
+		{ tr("Name"), [](const Galaxy::State *, const Galaxy::Empire *e) { return QVariant(e->getName()); } },
+		{ tr("Physics"), [](const Galaxy::State *, const Galaxy::Empire *e) { return QVariant(e->getIncome(Galaxy::Resource::PhysicsResearch)); } },
+		{ tr("Society"), [](const Galaxy::State *, const Galaxy::Empire *e) { return QVariant(e->getIncome(Galaxy::Resource::SocietyResearch)); } },
+		{ tr("Engineering"), [](const Galaxy::State *, const Galaxy::Empire *e) { return QVariant(e->getIncome(Galaxy::Resource::EngineeringResearch)); } },
+		{ tr("Technologies"), [](const Galaxy::State *s, const Galaxy::Empire *e) { return QVariant(s->getAggregates(e).technologyCount); } },
+		{ tr("Unique Technologies"), [](const Galaxy::State *s, const Galaxy::Empire *e) { return QVariant(s->getAggregates(e).uniqueTechnologies); } }
+	}, EmpireTableModel::RowFilter(), parent) {}
@@ -20,16 +20,12 @@
 #ifndef STELLARIS_STAT_VIEWER_RESEARCH_VIEW_H
 #define STELLARIS_STAT_VIEWER_RESEARCH_VIEW_H
 
-#include <QtWidgets/QTableWidget>
+#include "empire_table_view.h"
 
-namespace Galaxy { class State; }
-
-class ResearchView : public QTableWidget {
+class ResearchView : public EmpireTableView {
 	Q_OBJECT
 public:
-	ResearchView(QWidget* parent = nullptr);
-public slots:
-	void modelChanged(const Galaxy::State* newState);
+	ResearchView(QWidget *parent = nullptr);
 };
 
 #endif
\ No newline at end of file
@@ -20,16 +20,12 @@
 #ifndef STELLARIS_STAT_VIEWER_STRATEGIC_RESOURCES_VIEW_H
 #define STELLARIS_STAT_VIEWER_STRATEGIC_RESOURCES_VIEW_H
 
-#include <QtWidgets/QTableWidget>
+#include "empire_table_view.h"
 
-namespace Galaxy { class State; }
-
-class StrategicResourcesView : public QTableWidget {
+class StrategicResourcesView : public EmpireTableView {
 	Q_OBJECT
 public:
-	StrategicResourcesView(QWidget* parent = nullptr);
-public slots:
-	void modelChanged(const Galaxy::State* newState);
+	StrategicResourcesView(QWidget *parent = nullptr);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,145 @@
+/* tech_comparison_view.cpp: Compare the technologies of empires
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tech_comparison_view.h"
+
+#include <utility>
+
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QGridLayout>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QListWidget>
+#include <QtWidgets/QTableWidget>
+
+#include "../../../core/empire.h"
+#include "../../../core/galaxy_state.h"
+#include "../../../core/gametranslator.h"
+#include "../../../core/tracing.h"
+
+// The holders of a technology are only listed by name if there are at most this many.
+static const int maxListedHolders = 5;
+
+TechComparisonView::TechComparisonView(GameTranslator *t, QWidget *parent) : QSplitter(Qt::Vertical, parent), translator(t) {
+	QWidget *comparison = new QWidget;
+	QGridLayout *comparisonLayout = new QGridLayout;
+	firstEmpire = new QComboBox;
+	secondEmpire = new QComboBox;
+	connect(firstEmpire, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &TechComparisonView::selectedEmpiresChanged);
+	connect(secondEmpire, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &TechComparisonView::selectedEmpiresChanged);
+	summaryLabel = new QLabel;
+	summaryLabel->setAlignment(Qt::AlignCenter);
+	firstOnlyLabel = new QLabel(tr("Only researched by the first empire"));
+	secondOnlyLabel = new QLabel(tr("Only researched by the second empire"));
+	firstOnlyList = new QListWidget;
+	secondOnlyList = new QListWidget;
+	firstOnlyLabel->setBuddy(firstOnlyList);
+	secondOnlyLabel->setBuddy(secondOnlyList);
+	comparisonLayout->addWidget(firstEmpire, 0, 0);
+	comparisonLayout->addWidget(secondEmpire, 0, 1);
+	comparisonLayout->addWidget(summaryLabel, 1, 0, 1, 2);
+	comparisonLayout->addWidget(firstOnlyLabel, 2, 0);
+	comparisonLayout->addWidget(secondOnlyLabel, 2, 1);
+	comparisonLayout->addWidget(firstOnlyList, 3, 0);
+	comparisonLayout->addWidget(secondOnlyList, 3, 1);
+	comparisonLayout->setContentsMargins(1, 1, 1, 1);
+	comparison->setLayout(comparisonLayout);
+	addWidget(comparison);
+
+	holdersTable = new QTableWidget(0, 3);
+	holdersTable->setHorizontalHeaderLabels({ tr("Technology"), tr("Empires"), tr("Researched by") });
+	holdersTable->horizontalHeader()->setStretchLastSection(true);
+	holdersTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	holdersTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+	holdersTable->setToolTip(tr("Sort by the number of empires to find the rarest technologies."));
+	addWidget(holdersTable);
+}
+
+void TechComparisonView::modelChanged(const Galaxy::State *newState) {
+	SSV_TRACE_SCOPE("TechComparisonView::modelChanged");
+	state = newState;
+	empires.clear();
+	// The translator may have changed since the last time.
+	techNames.clear();
+	for (const QString &tech : state->getTechnologyNames()) techNames.append(translator->getTranslationOf(tech));
+
+	QStringList empireNames;
+	for (const Galaxy::Empire *empire : state->getEmpires()) {
+		empires.append(empire);
+		empireNames.append(empire->getName());
+	}
+	for (QComboBox *box : { firstEmpire, secondEmpire }) {
+		const QSignalBlocker blocker(box);
+		box->clear();
+		box->addItems(empireNames);
+	}
+	if (empires.size() > 1) secondEmpire->setCurrentIndex(1);
+	selectedEmpiresChanged();
+
+	const QVector<int> &holderCounts = state->getTechnologyHolderCounts();
+	holdersTable->setSortingEnabled(false);
+	holdersTable->clearContents();
+	holdersTable->setRowCount(techNames.size());
+	for (int id = 0; id < techNames.size(); id++) {
+		QStringList holders;
+		if (holderCounts[id] <= maxListedHolders) {
+			for (const Galaxy::Empire *empire : std::as_const(empires)) {
+				if (empire->hasTechnology(id)) holders.append(empire->getName());
+			}
+		}
+		auto *count = new QTableWidgetItem;
+		count->setData(Qt::DisplayRole, holderCounts[id]);
+		holdersTable->setItem(id, 0, new QTableWidgetItem(techNames[id]));
+		holdersTable->setItem(id, 1, count);
+		holdersTable->setItem(id, 2, new QTableWidgetItem(holders.join(QStringLiteral(", "))));
+	}
+	holdersTable->setSortingEnabled(true);
+	holdersTable->sortByColumn(1, Qt::AscendingOrder);
+}
+
+void TechComparisonView::selectedEmpiresChanged() {
+	firstOnlyList->clear();
+	secondOnlyList->clear();
+	const int first = firstEmpire->currentIndex(), second = secondEmpire->currentIndex();
+	if (first < 0 || second < 0) {
+		summaryLabel->clear();
+		return;
+	}
+	const Galaxy::DynamicBitset &firstTechs = empires[first]->getTechnologies();
+	const Galaxy::DynamicBitset &secondTechs = empires[second]->getTechnologies();
+	const Galaxy::DynamicBitset firstOnly(firstTechs - secondTechs), secondOnly(secondTechs - firstTechs);
+	summaryLabel->setText(tr("%1 technologies in common, %2 only researched by %3, %4 only researched by %5")
+			.arg(firstTechs.countCommon(secondTechs)).arg(firstOnly.count()).arg(empires[first]->getName())
+			.arg(secondOnly.count()).arg(empires[second]->getName()));
+	firstOnlyLabel->setText(tr("Only researched by %1").arg(empires[first]->getName()));
+	secondOnlyLabel->setText(tr("Only researched by %1").arg(empires[second]->getName()));
+
+	QVector<int> ids;
+	for (int id = firstOnly.next(0); id >= 0; id = firstOnly.next(id + 1)) ids.append(id);
+	fillList(firstOnlyList, ids);
+	ids.clear();
+	for (int id = secondOnly.next(0); id >= 0; id = secondOnly.next(id + 1)) ids.append(id);
+	fillList(secondOnlyList, ids);
+}
+
+void TechComparisonView::fillList(QListWidget *list, const QVector<int> &techIds) {
+	QStringList names;
+	names.reserve(techIds.size());
+	for (int id : techIds) names.append(techNames[id]);
+	list->addItems(names);
+	list->sortItems();
+}
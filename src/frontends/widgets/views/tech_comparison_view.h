@@ -0,0 +1,61 @@
+/* tech_comparison_view.h: Compare the technologies of empires (header file)
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#ifndef STELLARIS_STAT_VIEWER_TECH_COMPARISON_VIEW_H
+#define STELLARIS_STAT_VIEWER_TECH_COMPARISON_VIEW_H
+
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+#include <QtWidgets/QSplitter>
+class QComboBox;
+class QLabel;
+class QListWidget;
+class QTableWidget;
+
+namespace Galaxy {
+	class Empire;
+	class State;
+}
+class GameTranslator;
+
+/** Which technologies one empire has and another one hasn't, and how widespread each technology is. */
+class TechComparisonView : public QSplitter {
+	Q_OBJECT
+public:
+	TechComparisonView(GameTranslator *t, QWidget *parent = nullptr);
+public slots:
+	void modelChanged(const Galaxy::State *newState);
+
+private slots:
+	void selectedEmpiresChanged();
+private:
+	void fillList(QListWidget *list, const QVector<int> &techIds);
+
+	QComboBox *firstEmpire, *secondEmpire;
+	QLabel *summaryLabel, *firstOnlyLabel, *secondOnlyLabel;
+	QListWidget *firstOnlyList, *secondOnlyList;
+	QTableWidget *holdersTable;
+	GameTranslator *translator;
+
+	const Galaxy::State *state = nullptr;
+	QVector<const Galaxy::Empire *> empires;  // in the order of the combo boxes
+	QStringList techNames;  // translated, by the state's technology ids
+};
+
+#endif //STELLARIS_STAT_VIEWER_TECH_COMPARISON_VIEW_H
@@ -17,13 +17,20 @@
 
 #include "techs_view.h"
 
+#include <utility>
+
+#include <QtCore/QDir>
+#include <QtCore/QSettings>
 #include <QtWidgets/QHBoxLayout>
 #include <QtWidgets/QListWidget>
 #include <QtWidgets/QLabel>
 
 #include "../../../core/gametranslator.h"
+#include "../../../core/galaxy_model.h"
 #include "../../../core/galaxy_state.h"
 #include "../../../core/empire.h"
+#include "../../../core/technology.h"
+#include "../../../core/tracing.h"
 
 TechView::TechView(GameTranslator *t, QWidget* parent) : QSplitter(parent), translator(t) {
 	leftSide = new QWidget;
@@ -48,27 +55,125 @@ TechView::TechView(GameTranslator *t, QWidget* parent) : QSplitter(parent), tran
 	rightSide->setLayout(layoutRight);
 	layoutRight->setContentsMargins(1, 1, 1, 1);
 	addWidget(rightSide);
+
+	frontierSide = new QWidget;
+	layoutFrontier = new QVBoxLayout;
+	frontierList = new QListWidget;
+	frontierListLabel = new QLabel(tr("Available Research"));
+	frontierListLabel->setBuddy(frontierList);
+	frontierListLabel->setToolTip(tr("Technologies whose prerequisites the empire has all researched. "
+			"This requires the game folder to be set."));
+	layoutFrontier->addWidget(frontierListLabel);
+	layoutFrontier->addWidget(frontierList);
+	frontierSide->setLayout(layoutFrontier);
+	layoutFrontier->setContentsMargins(1, 1, 1, 1);
+	addWidget(frontierSide);
+
+	connect(&techFilesWatcher, &QFutureWatcher<QVector<Galaxy::Technology *>>::finished, this, &TechView::techFilesRead);
+}
+
+TechView::~TechView() {
+	// Same as in TechTreeDialog: let the workers finish, then throw their results away.
+	if (techFilesWatcher.isRunning()) {
+		techFilesWatcher.waitForFinished();
+		for (const auto &fileTechs : techFilesWatcher.future().results()) qDeleteAll(fileTechs);
+	}
+}
+
+// The game's technologies are only read once per game folder -- and usually from the cache. They are read
+// in the background; until they are in, the frontier is hidden.
+void TechView::updateTechGraph() {
+	QSettings settings;
+	const QString folder(settings.value("game/folder", QString()).toString());
+	// Once the current read is done, techFilesRead() checks the folder again.
+	if (techFilesWatcher.isRunning() || (folder == techGraphFolder && techModel)) return;
+	techGraphFolder = folder;
+	techModel.reset(new Galaxy::Model);
+	techGraph = Galaxy::TechGraph(*techModel);
+	updateGraphIds();  // the old ones are no longer valid
+	frontierSide->setVisible(false);
+	const QDir techDir(folder + "/common/technology");
+	if (folder == "" || !techDir.exists()) return;
+	techFiles = techDir.entryInfoList(QStringList("*.txt"), QDir::Files, QDir::Name);
+	if (!techCache) techCache.reset(new Galaxy::TechCache);
+	techFilesWatcher.setFuture(readTechFiles(techFiles, thread(), techCache.get()));
+}
+
+void TechView::techFilesRead() {
+	adoptTechFiles(techFiles, techFilesWatcher.future().results(), techModel.get(), techCache.get());
+	techGraph = Galaxy::TechGraph(*techModel);
+	frontierSide->setVisible(techGraph.size() > 0);
+	updateGraphIds();
+	if (empireList->currentItem()) selectedEmpireChanged(empireList->currentItem()->text());
+	// The game folder may have been changed in the meantime.
+	updateTechGraph();
+}
+
+void TechView::updateGraphIds() {
+	graphIds.clear();
+	graphIds.reserve(stateTechNames.size());
+	for (const QString &tech : std::as_const(stateTechNames)) graphIds.append(techGraph.idOf(tech));
+}
+
+const QString &TechView::techName(const QString &tech) {
+	auto known = techNames.constFind(tech);
+	if (known == techNames.cend()) known = techNames.insert(tech, translator->getTranslationOf(tech));
+	return known.value();
 }
 
 void TechView::modelChanged(const Galaxy::State *newModel) {
+	SSV_TRACE_SCOPE("TechView::modelChanged");
 	empireList->clear();
 	techsList->clear();
+	frontierList->clear();
+	empireTechs.clear();
+	updateTechGraph();
+	// The translator may have changed since the last time, so forget everything translated so far.
+	techNames.clear();
+	stateTechNames = newModel->getTechnologyNames();
+	updateGraphIds();
 	const QMap<qint64, Galaxy::Empire *> &empires = newModel->getEmpires();
 	for (auto it = empires.cbegin(); it != empires.cend(); it++) {
 		Galaxy::Empire *empire = it.value();
-		QStringList translatedTechs;
-		for (const auto &tech: empire->getTechnologies()) {
-			translatedTechs << translator->getTranslationOf(tech);
-		}
-		empireTechs.insert(empire->getName(), translatedTechs);
+		empireTechs.insert(empire->getName(), empire->getTechnologies());
 		empireList->addItem(empire->getName());
 	}
 	techsListLabel->setText(tr("Researched Technologies"));
+	frontierListLabel->setText(tr("Available Research"));
 }
 
+// Techs are only translated when an empire is selected, and each tech only once, no matter how
+// many empires have researched it.
 void TechView::selectedEmpireChanged(const QString &newEmpire) {
 	techsList->clear();
-	const QStringList &techs = empireTechs.value(newEmpire);
-	techsListLabel->setText(tr("Researched Technologies (%1)").arg(techs.count()));
-	techsList->addItems(techs);
-}
\ No newline at end of file
+	frontierList->clear();
+	const Galaxy::DynamicBitset techs = empireTechs.value(newEmpire);
+	const int techCount = techs.count();
+	techsListLabel->setText(tr("Researched Technologies (%1)").arg(techCount));
+	QStringList translatedTechs;
+	translatedTechs.reserve(techCount);
+	// The game's technologies are numbered differently from those of the save.
+	Galaxy::DynamicBitset researched(techGraph.size());
+	for (int id = techs.next(0); id >= 0; id = techs.next(id + 1)) {
+		translatedTechs.append(techName(stateTechNames[id]));
+		if (graphIds[id] >= 0 && graphIds[id] < techGraph.size()) researched.set(graphIds[id]);
+	}
+	techsList->addItems(translatedTechs);
+
+	if (techGraph.size() == 0) return;
+	const Galaxy::DynamicBitset frontier(techGraph.frontier(researched));
+	frontierListLabel->setText(tr("Available Research (%1)").arg(frontier.count()));
+	for (int id = frontier.next(0); id >= 0; id = frontier.next(id + 1)) {
+		const Galaxy::Technology *tech = techGraph.technology(id);
+		auto *item = new QListWidgetItem(techName(tech->getName()), frontierList);
+		const int unlocks = techGraph.unlockedBy(id, researched).count();
+		item->setToolTip(tr("Researching this makes %n more technologies available.", nullptr, unlocks));
+		// Technologies that open up more of the tree stand out.
+		if (unlocks > 0) {
+			QFont font(item->font());
+			font.setBold(true);
+			item->setFont(font);
+		}
+	}
+	frontierList->sortItems();
+}
@@ -20,16 +20,27 @@
 #ifndef STELLARIS_STAT_VIEWER_TECHS_VIEW_H
 #define STELLARIS_STAT_VIEWER_TECHS_VIEW_H
 
+#include <memory>
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QHash>
 #include <QtCore/QMap>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
+#include <QtCore/QVector>
 #include <QtWidgets/QSplitter>
+
+#include "../../../core/techgraph.h"
 class QVBoxLayout;
 class QLabel;
 class QListWidget;
 
 namespace Galaxy {
+	class Model;
 	class State;
+	class TechCache;
+	class Technology;
 }
 class GameTranslator;
 
@@ -37,21 +48,39 @@ class TechView : public QSplitter {
 	Q_OBJECT
 public:
 	TechView(GameTranslator *t, QWidget *parent = nullptr);
+	~TechView() override;
 public slots:
 	void modelChanged(const Galaxy::State *newModel);
 
 private slots:
 	void selectedEmpireChanged(const QString &newEmpireName);
+	void techFilesRead();
 private:
-	QVBoxLayout *layoutLeft, *layoutRight;
+	void updateTechGraph();
+	void updateGraphIds();
+	const QString &techName(const QString &tech);
+
+	QVBoxLayout *layoutLeft, *layoutRight, *layoutFrontier;
 	QLabel *empireListLabel;
-	QLabel *techsListLabel;
+	QLabel *techsListLabel, *frontierListLabel;
 	QListWidget *empireList;
-	QListWidget *techsList;
-	QWidget *leftSide, *rightSide;
+	QListWidget *techsList, *frontierList;
+	QWidget *leftSide, *rightSide, *frontierSide;
 	GameTranslator *translator;
 
-	QMap<QString, QStringList> empireTechs;
+	// untranslated
+	QMap<QString, Galaxy::DynamicBitset> empireTechs;
+	QStringList stateTechNames;
+	QHash<QString, QString> techNames;
+	QVector<int> graphIds;  // TechGraph id of each of the state's technologies, or -1
+
+	// The game's technologies, for working out what each empire can research next.
+	std::unique_ptr<Galaxy::Model> techModel;
+	Galaxy::TechGraph techGraph;
+	QString techGraphFolder;
+	std::unique_ptr<Galaxy::TechCache> techCache;
+	QFileInfoList techFiles;
+	QFutureWatcher<QVector<Galaxy::Technology *>> techFilesWatcher;
 };
 
 #endif //STELLARIS_STAT_VIEWER_TECHS_H
\ No newline at end of file
@@ -15,11 +15,16 @@
  * limitations under the License.
  */
 
+#include <QtCore/QThread>
 #include <QtWidgets/QApplication>
 #include "mainwindow.h"
+#include "../../core/tracing.h"
 
 int frontend_widgets_begin(int argc, char **argv) {
 	QApplication app(argc, argv);
+	QThread::currentThread()->setObjectName(QStringLiteral("GUI"));
+	Tracing::StopGuard traceGuard;
+	Tracing::startFromEnvironment();
 	MainWindow window;
 	window.show();
 	return app.exec();
@@ -1,4 +1,5 @@
 #include <QtCore/QCoreApplication>
+#include <QtCore/QVector>
 
 #include "frontends.h"
 
@@ -7,26 +8,23 @@ int main(int argc, char** argv) {
 	QCoreApplication::setOrganizationName("ArdiMaster");
 	QCoreApplication::setOrganizationDomain("diepixelecke.de");
 
-	if (argc == 2 && strncmp(argv[1], "--frontend=", 11) != 0) {
-		// called as "ssv_json.exe <file>"
-		int new_argc = 3;
-		char* new_argv[] = { argv[0], 0, argv[1] };
-		return frontend_json_begin(new_argc, new_argv);
+	if (argc >= 2 && strncmp(argv[1], "--frontend=", 11) != 0) {
+		// called as "ssv_json.exe [options] <file>"
+		QVector<char*> new_argv;
+		new_argv << argv[0] << nullptr;
+		for (int i = 1; i < argc; i++) new_argv << argv[i];
+		return frontend_json_begin(new_argv.size(), new_argv.data());
 	}
 
 	if (argc >= 2) {
-		if (strncmp(argv[1], "--frontend=", 11) == 0) {
-			char* frontendstr = &argv[1][11];
-			if (strcmp(frontendstr, "json") != 0) {
-				fprintf(stderr, "Error: %s is a special executable and must be used with `--frontend=json'.\n", argv[0]);
-				return 1;
-			}
-		} else {
-			fprintf(stderr, "USAGE: %s [--frontend=json] <file>\n", argv[0]);
+		// any other first argument has been handled above
+		char* frontendstr = &argv[1][11];
+		if (strcmp(frontendstr, "json") != 0) {
+			fprintf(stderr, "Error: %s is a special executable and must be used with `--frontend=json'.\n", argv[0]);
 			return 1;
 		}
 		return frontend_json_begin(argc, argv);
 	}
-	fprintf(stderr, "USAGE: %s [--frontend=json] <file>\n", argv[0]);
+	fprintf(stderr, "USAGE: %s [--frontend=json] [--compact] [--format=json|cbor] <file>\n", argv[0]);
 	return 1;
 }
\ No newline at end of file
@@ -0,0 +1,160 @@
+/* tests/bench/gamestate_generator.cpp: Deterministic synthetic save files for benchmarking
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gamestate_generator.h"
+
+#include <QtCore/QRandomGenerator>
+#include <QtCore/QtEndian>
+
+static const char *const shipSizes[] = { "corvette", "destroyer", "cruiser", "battleship", "starbase_outpost" };
+static const int designCount = sizeof(shipSizes) / sizeof(shipSizes[0]);
+
+static QByteArray indent(int depth) {
+	return QByteArray(depth, '\t');
+}
+
+static void writeNested(QByteArray &out, QRandomGenerator &random, int level, int depth) {
+	const QByteArray tabs(indent(level + 1));
+	out += tabs + "level" + QByteArray::number(level) + "={\n";
+	out += tabs + "\tvalue=" + QByteArray::number(random.bounded(1000)) + "\n";
+	out += tabs + "\tweight=" + QByteArray::number(random.generateDouble() * 10, 'f', 5) + "\n";
+	out += tabs + "\tactive=" + (random.bounded(2) ? "yes" : "no") + "\n";
+	if (level + 1 < depth) writeNested(out, random, level + 1, depth);
+	out += tabs + "}\n";
+}
+
+QByteArray generateGamestate(const GamestateOptions &options) {
+	QRandomGenerator random(options.seed);
+	QByteArray out;
+	out += "version=\"Benchmark v1.0\"\ndate=\"2300.01.01\"\n";
+
+	out += "country={\n";
+	for (int e = 0; e < options.empires; e++) {
+		out += QByteArray::number(e) + "={\n\tname=\"Empire " + QByteArray::number(e) + "\"\n\tflag=1\n\tcolor=2\n";
+		out += "\ttech_status={\n";
+		for (int t = 0; t < options.techsPerEmpire; t++) {
+			// Empires share most technologies, but not all of them.
+			const int tech = t + random.bounded(options.techsPerEmpire / 10 + 1);
+			out += "\t\ttechnology=\"tech_" + QByteArray::number(tech) + "\"\n\t\tlevel=1\n";
+		}
+		out += "\t}\n\tmilitary_power=" + QByteArray::number(random.generateDouble() * 100000, 'f', 5);
+		out += "\n\teconomy_power=" + QByteArray::number(random.generateDouble() * 5000, 'f', 5);
+		out += "\n\tvictory_rank=1\n\tvictory_score=2.00000\n\ttech_power=" + QByteArray::number(random.generateDouble() * 2000, 'f', 5);
+		out += "\n\tbudget={\n\t\tlast_month={\n\t\t\tbalance={\n\t\t\t\tcountry_base={\n";
+		out += "\t\t\t\t\tenergy=" + QByteArray::number(random.generateDouble() * 100, 'f', 5);
+		out += "\n\t\t\t\t\tminerals=" + QByteArray::number(random.generateDouble() * 100, 'f', 5);
+		out += "\n\t\t\t\t\tphysics_research=" + QByteArray::number(random.bounded(500)) + "\n";
+		out += "\t\t\t\t}\n\t\t\t}\n\t\t}\n\t}\n";
+
+		out += "\towned_planets={";
+		for (int i = 0; i < options.listSize; i++) out += " " + QByteArray::number(random.bounded(100000));
+		out += " }\n\tmodifiers={";
+		for (int i = 0; i < options.listSize; i++) out += " " + QByteArray::number(random.generateDouble(), 'f', 5);
+		out += " }\n\tpolicies={";
+		for (int i = 0; i < options.listSize; i++) out += " \"policy_" + QByteArray::number(random.bounded(50)) + "\"";
+		out += " }\n";
+		if (options.nestingDepth > 0) writeNested(out, random, 0, options.nestingDepth);
+		out += "}\n";
+	}
+	out += "}\n";
+
+	const int fleetCount = options.empires * options.fleetsPerEmpire;
+	out += "fleet={\n";
+	for (int f = 0; f < fleetCount; f++) {
+		out += QByteArray::number(f) + "={\n\tname=\"Fleet " + QByteArray::number(f) + "\"\n\ta=1\n\tb=2\n\tc=3\n";
+		out += "\towner=" + QByteArray::number(f / options.fleetsPerEmpire);
+		out += "\n\tstation=" + QByteArray(f % options.fleetsPerEmpire ? "no" : "yes");
+		out += "\n\tmilitary_power=" + QByteArray::number(random.generateDouble() * 10000, 'f', 5) + "\n}\n";
+	}
+	out += "}\n";
+
+	out += "ship_design={\n";
+	for (int d = 0; d < designCount; d++) {
+		out += QByteArray::number(d) + "={\n\tname=\"Design\"\n\tship_size=" + shipSizes[d] + "\n}\n";
+	}
+	out += "}\n";
+
+	out += "ships={\n";
+	for (int s = 0; s < fleetCount * options.shipsPerFleet; s++) {
+		out += QByteArray::number(s) + "={\n\tfleet=" + QByteArray::number(s / options.shipsPerFleet);
+		out += "\n\tname=\"Ship\"\n\tkey=1\n\tship_design=" + QByteArray::number(random.bounded(designCount)) + "\n}\n";
+	}
+	out += "}\n";
+	return out;
+}
+
+static void appendLE16(QByteArray &out, quint16 value) {
+	char bytes[2];
+	qToLittleEndian(value, bytes);
+	out.append(bytes, 2);
+}
+
+static void appendLE32(QByteArray &out, quint32 value) {
+	char bytes[4];
+	qToLittleEndian(value, bytes);
+	out.append(bytes, 4);
+}
+
+// The fields shared by the local file header and the central directory entry, from "version needed"
+// to the file name length. SSV doesn't check the CRC, so it is left at zero.
+static void appendEntryFields(QByteArray &out, quint32 compressedSize, quint32 size) {
+	appendLE16(out, 20);  // version needed to extract
+	appendLE16(out, 0);  // flags
+	appendLE16(out, 8);  // deflate
+	appendLE16(out, 0);  // modification time
+	appendLE16(out, 0x5021);  // modification date: 2020-01-01
+	appendLE32(out, 0);  // CRC-32
+	appendLE32(out, compressedSize);
+	appendLE32(out, size);
+	appendLE16(out, 9);  // strlen("gamestate")
+}
+
+QByteArray makeSaveArchive(const QByteArray &gamestate) {
+	// qCompress writes a 4-byte length and a zlib stream, which is a 2-byte header, the raw
+	// deflate data that ZIP wants, and a 4-byte checksum.
+	const QByteArray zlib(qCompress(gamestate, 6));
+	const QByteArray deflated(zlib.mid(6, zlib.size() - 10));
+	QByteArray out;
+	appendLE32(out, 0x04034b50);
+	appendEntryFields(out, deflated.size(), gamestate.size());
+	appendLE16(out, 0);  // extra field length
+	out += "gamestate";
+	out += deflated;
+
+	const quint32 directoryOffset = out.size();
+	appendLE32(out, 0x02014b50);
+	appendLE16(out, 20);  // version made by
+	appendEntryFields(out, deflated.size(), gamestate.size());
+	appendLE16(out, 0);  // extra field length
+	appendLE16(out, 0);  // comment length
+	appendLE16(out, 0);  // disk number
+	appendLE16(out, 0);  // internal attributes
+	appendLE32(out, 0);  // external attributes
+	appendLE32(out, 0);  // offset of the local header
+	out += "gamestate";
+	const quint32 directorySize = out.size() - directoryOffset;
+
+	appendLE32(out, 0x06054b50);
+	appendLE16(out, 0);  // this disk
+	appendLE16(out, 0);  // disk with the central directory
+	appendLE16(out, 1);  // entries on this disk
+	appendLE16(out, 1);  // entries in total
+	appendLE32(out, directorySize);
+	appendLE32(out, directoryOffset);
+	appendLE16(out, 0);  // comment length
+	return out;
+}
@@ -0,0 +1,46 @@
+/* tests/bench/gamestate_generator.h: Deterministic synthetic save files for benchmarking (header file)
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#ifndef STELLARIS_STAT_VIEWER_GAMESTATE_GENERATOR_H
+#define STELLARIS_STAT_VIEWER_GAMESTATE_GENERATOR_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QtGlobal>
+
+/** The shape of a generated gamestate. The same options always produce the same bytes. */
+struct GamestateOptions {
+	int empires = 100;
+	int fleetsPerEmpire = 4;
+	int shipsPerFleet = 5;
+	int techsPerEmpire = 150;
+	/** Number of elements in each of the int, double and string lists that every empire gets. */
+	int listSize = 8;
+	/** How deeply the compound that every empire gets is nested. */
+	int nestingDepth = 3;
+	quint32 seed = 1;
+};
+
+/** A gamestate with everything StateFactory looks at, laid out the way the game writes it, plus
+ *  some filler of the kinds of nodes that the parser has to get through in real saves. */
+QByteArray generateGamestate(const GamestateOptions &options);
+
+/** Pack `gamestate' into a .sav file: a ZIP archive with the gamestate as its first, deflated entry. */
+QByteArray makeSaveArchive(const QByteArray &gamestate);
+
+#endif //STELLARIS_STAT_VIEWER_GAMESTATE_GENERATOR_H
@@ -0,0 +1,271 @@
+/* tests/bench/ssv_bench.cpp: Benchmarks for the loading pipeline, on synthetic saves
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <stack>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <QtCore/QBuffer>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryFile>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "../../src/core/extract_gamestate.h"
+#include "../../src/core/galaxy_state.h"
+#include "../../src/core/parser.h"
+#include "../../src/frontends/json/dataextraction.h"
+#include "gamestate_generator.h"
+
+#ifndef SSV_VERSION
+#define SSV_VERSION "<unknown>"
+#endif
+
+using namespace Parsing;
+
+static void printUsage(const char *argv0) {
+	fprintf(stderr, "USAGE: %s [--empires=N] [--fleets=N] [--ships=N] [--techs=N] [--list-size=N]\n"
+			  "          [--depth=N] [--seed=N] [--iterations=N] [--compact]\n\n"
+			  "  Generate a synthetic gamestate, time each stage of loading it and write the\n"
+			  "  results to stdout as JSON.\n\n"
+			  "  --empires=N     Number of empires (default 100)\n"
+			  "  --fleets=N      Fleets per empire (default 4)\n"
+			  "  --ships=N       Ships per fleet (default 5)\n"
+			  "  --techs=N       Technologies per empire (default 150)\n"
+			  "  --list-size=N   Elements in each of an empire's lists (default 8)\n"
+			  "  --depth=N       Depth of an empire's nested compound (default 3)\n"
+			  "  --seed=N        Seed for the generated values (default 1)\n"
+			  "  --iterations=N  How often to run each benchmark; the best run is reported (default 5)\n"
+			  "  --compact       Omit all optional whitespace from the output\n", argv0);
+}
+
+static bool parseIntArg(const char *arg, const char *name, int *value) {
+	const size_t length = strlen(name);
+	if (strncmp(arg, name, length) != 0) return false;
+	*value = atoi(arg + length);
+	return true;
+}
+
+// Peak resident set size of this process so far, in bytes.
+static qint64 peakRss() {
+#ifdef Q_OS_WIN
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return -1;
+	return counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#ifdef Q_OS_MAC
+	return usage.ru_maxrss;  // already in bytes
+#else
+	return usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+static qint64 countNodes(const AstNode *root) {
+	qint64 count = 0;
+	std::stack<const AstNode *> pending;
+	pending.push(root);
+	while (!pending.empty()) {
+		const AstNode *node = pending.top();
+		pending.pop();
+		count++;
+		const bool hasChildren = node->type == NT_COMPOUND || node->type == NT_INTLIST || node->type == NT_DOUBLELIST
+				|| node->type == NT_COMPOUNDLIST || node->type == NT_STRINGLIST || node->type == NT_BOOLLIST
+				|| node->type == NT_COMPOUNDLIST_MEMBER;
+		if (!hasChildren) continue;
+		for (const AstNode *child = node->val.firstChild; child; child = child->nextSibling) pending.push(child);
+	}
+	return count;
+}
+
+class Benchmarks {
+public:
+	explicit Benchmarks(int iterations) : iterations(iterations) {}
+
+	/** Run `body' `iterations' times. `bytes' and `items' are what a single run processes; `itemName'
+	 *  says what the items are. `body' returns false if something went wrong. */
+	bool run(const char *name, qint64 bytes, qint64 items, const char *itemName, const std::function<bool()> &body) {
+		QVector<double> seconds;
+		for (int i = 0; i < iterations; i++) {
+			QElapsedTimer timer;
+			timer.start();
+			if (!body()) {
+				fprintf(stderr, "%s: failed.\n", name);
+				return false;
+			}
+			seconds.append(timer.nsecsElapsed() / 1e9);
+		}
+		std::sort(seconds.begin(), seconds.end());
+		const double best = seconds.first();
+		QJsonObject result;
+		result.insert("name", name);
+		result.insert("iterations", iterations);
+		result.insert("best_seconds", best);
+		result.insert("median_seconds", seconds[seconds.size() / 2]);
+		result.insert("bytes", bytes);
+		result.insert("mb_per_s", bytes / best / 1e6);
+		if (items >= 0) {
+			result.insert(itemName, items);
+			result.insert(QString("%1_per_s").arg(itemName), items / best);
+		}
+		results.append(result);
+		fprintf(stderr, "%-8s %10.3f ms  %8.1f MB/s\n", name, best * 1e3, bytes / best / 1e6);
+		return true;
+	}
+
+	QJsonArray results;
+private:
+	int iterations;
+};
+
+int main(int argc, char **argv) {
+	QCoreApplication app(argc, argv);
+	GamestateOptions options;
+	int seed = options.seed, iterations = 5;
+	bool compact = false;
+	for (int i = 1; i < argc; i++) {
+		if (parseIntArg(argv[i], "--empires=", &options.empires)
+				|| parseIntArg(argv[i], "--fleets=", &options.fleetsPerEmpire)
+				|| parseIntArg(argv[i], "--ships=", &options.shipsPerFleet)
+				|| parseIntArg(argv[i], "--techs=", &options.techsPerEmpire)
+				|| parseIntArg(argv[i], "--list-size=", &options.listSize)
+				|| parseIntArg(argv[i], "--depth=", &options.nestingDepth)
+				|| parseIntArg(argv[i], "--seed=", &seed)
+				|| parseIntArg(argv[i], "--iterations=", &iterations)) {
+			continue;
+		} else if (strcmp(argv[i], "--compact") == 0) {
+			compact = true;
+		} else {
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+	options.seed = seed;
+	if (options.empires < 1 || options.fleetsPerEmpire < 1 || options.shipsPerFleet < 0 || options.techsPerEmpire < 0
+			|| options.listSize < 0 || options.nestingDepth < 0 || iterations < 1) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	fprintf(stderr, "Generating gamestate ...\n");
+	const QByteArray gamestate(generateGamestate(options));
+	QTemporaryFile saveFile;
+	if (!saveFile.open() || saveFile.write(makeSaveArchive(gamestate)) < 0 || !saveFile.flush()) {
+		fprintf(stderr, "Unable to write the save file.\n");
+		return 2;
+	}
+	MemBuf buf(gamestate);
+	Benchmarks benchmarks(iterations);
+
+	bool ok = benchmarks.run("inflate", gamestate.size(), -1, nullptr, [&saveFile]() {
+		saveFile.seek(0);
+		unsigned char *content = nullptr;
+		unsigned long contentSize;
+		const int result = extractGamestate(saveFile, &content, &contentSize);
+		free(content);
+		return result == 0;
+	});
+
+	qint64 tokens = 0;
+	ok = ok && benchmarks.run("lex", gamestate.size(), -1, nullptr, [&buf, &tokens]() {
+		buf.rewind();
+		Parser parser(buf, FileType::SaveFile);
+		tokens = parser.lexAll();
+		return tokens >= 0;
+	});
+	// Only now is the number of tokens known; put it in after the fact.
+	if (ok) {
+		QJsonObject lexResult(benchmarks.results.last().toObject());
+		lexResult.insert("tokens", tokens);
+		lexResult.insert("tokens_per_s", tokens / lexResult.value("best_seconds").toDouble());
+		benchmarks.results.last() = lexResult;
+	}
+
+	buf.rewind();
+	Parser treeParser(buf, FileType::SaveFile);
+	AstNode *tree = ok ? treeParser.parse() : nullptr;
+	if (!tree) {
+		fprintf(stderr, "Unable to parse the generated gamestate.\n");
+		return 3;
+	}
+	const qint64 nodes = countNodes(tree);
+	ok = benchmarks.run("parse", gamestate.size(), nodes, "nodes", [&buf]() {
+		buf.rewind();
+		Parser parser(buf, FileType::SaveFile);
+		return parser.parse() != nullptr;
+	});
+
+	Galaxy::State *state = nullptr;
+	ok = ok && benchmarks.run("extract", gamestate.size(), nodes, "nodes", [tree, &state]() {
+		delete state;
+		Galaxy::StateFactory factory;
+		state = factory.createFromAst(tree, nullptr);
+		return state != nullptr;
+	});
+
+	QByteArray json;
+	if (ok) {
+		QBuffer out(&json);
+		out.open(QIODevice::WriteOnly);
+		writeJsonFromState(&out, state, true);
+	}
+	ok = ok && benchmarks.run("json", json.size(), state->getEmpires().size(), "empires", [state]() {
+		QByteArray result;
+		QBuffer out(&result);
+		out.open(QIODevice::WriteOnly);
+		return writeJsonFromState(&out, state, true);
+	});
+	delete state;
+	if (!ok) return 3;
+
+	QJsonObject generator;
+	generator.insert("empires", options.empires);
+	generator.insert("fleets_per_empire", options.fleetsPerEmpire);
+	generator.insert("ships_per_fleet", options.shipsPerFleet);
+	generator.insert("techs_per_empire", options.techsPerEmpire);
+	generator.insert("list_size", options.listSize);
+	generator.insert("nesting_depth", options.nestingDepth);
+	generator.insert("seed", qint64(options.seed));
+	generator.insert("gamestate_bytes", gamestate.size());
+	QJsonObject report;
+	report.insert("version", SSV_VERSION);
+	report.insert("generator", generator);
+	report.insert("results", benchmarks.results);
+	// The peak of the whole run -- generator and all stages together. The kernel only tracks the peak per process,
+	// so there is no figure for any one stage.
+	report.insert("peak_rss_bytes", peakRss());
+
+	QFile out;
+	if (!out.open(stdout, QIODevice::WriteOnly)) return 4;
+	out.write(QJsonDocument(report).toJson(compact ? QJsonDocument::Compact : QJsonDocument::Indented));
+	return 0;
+}
@@ -0,0 +1,108 @@
+/* tests/bench_export.cpp: Comparing the JSON and CBOR export formats
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtCore/QBuffer>
+#include <QtCore/QCborValue>
+#include <QtCore/QJsonDocument>
+#include <QtTest/QtTest>
+
+#include "../src/core/galaxy_state.h"
+#include "../src/core/parser.h"
+#include "../src/frontends/json/dataextraction.h"
+#include "bench/gamestate_generator.h"
+
+using namespace Parsing;
+
+class BenchExport : public QObject {
+	Q_OBJECT
+private slots:
+	void initTestCase() {
+		GamestateOptions options;
+		options.empires = 1000;
+		buf = new MemBuf(generateGamestate(options));
+		parser = new Parser(*buf, FileType::NoFile);
+		AstNode *tree = parser->parse();
+		QVERIFY(tree != nullptr);
+		Galaxy::StateFactory factory;
+		state = factory.createFromAst(tree, nullptr);
+		QVERIFY(state != nullptr);
+		QCOMPARE(state->getEmpires().size(), qsizetype(1000));
+
+		QBuffer jsonOut(&json);
+		jsonOut.open(QIODevice::WriteOnly);
+		QVERIFY(writeJsonFromState(&jsonOut, state, true));
+		QBuffer cborOut(&cbor);
+		cborOut.open(QIODevice::WriteOnly);
+		QVERIFY(writeCborFromState(&cborOut, state));
+		qInfo("Compact JSON: %lld bytes, CBOR: %lld bytes (%.1f%%)", (long long) json.size(), (long long) cbor.size(),
+		      100.0 * cbor.size() / json.size());
+	}
+
+	void cleanupTestCase() {
+		delete state;
+		delete parser;
+		delete buf;
+	}
+
+	void encodeJson() {
+		QByteArray result;
+		QBENCHMARK {
+			result.clear();
+			QBuffer out(&result);
+			out.open(QIODevice::WriteOnly);
+			writeJsonFromState(&out, state, true);
+		}
+		QCOMPARE(result, json);
+	}
+
+	void encodeCbor() {
+		QByteArray result;
+		QBENCHMARK {
+			result.clear();
+			QBuffer out(&result);
+			out.open(QIODevice::WriteOnly);
+			writeCborFromState(&out, state);
+		}
+		QCOMPARE(result, cbor);
+	}
+
+	void decodeJson() {
+		QJsonDocument doc;
+		QBENCHMARK {
+			doc = QJsonDocument::fromJson(json);
+		}
+		QCOMPARE(doc.object().value("content").toObject().size(), qsizetype(1000));
+	}
+
+	void decodeCbor() {
+		QCborValue value;
+		QBENCHMARK {
+			value = QCborValue::fromCbor(cbor);
+		}
+		QCOMPARE(value.toMap().value(QStringLiteral("content")).toMap().size(), qsizetype(1000));
+	}
+
+private:
+	MemBuf *buf = nullptr;
+	Parser *parser = nullptr;
+	Galaxy::State *state = nullptr;
+	QByteArray json, cbor;
+};
+
+QTEST_GUILESS_MAIN(BenchExport);
+
+#include "bench_export.moc"
@@ -0,0 +1,110 @@
+/* tests/test_instrumentation.cpp: Unit testing for src/core/instrumentation.h
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtTest/QtTest>
+
+#include "../src/core/instrumentation.h"
+#include "../src/core/parser.h"
+
+using namespace Parsing;
+
+class TestInstrumentation : public QObject {
+	Q_OBJECT
+private slots:
+	void timerWithoutStatistics() {
+		// Must not crash, and there is nothing else to observe.
+		ScopedTimer timer(nullptr, LoadStatistics::Parse);
+	}
+
+	void timerAddsUp() {
+		LoadStatistics statistics;
+		QVERIFY(statistics.isEmpty());
+		{
+			ScopedTimer timer(&statistics, LoadStatistics::Serialize);
+			QTest::qSleep(2);
+		}
+		const qint64 first = statistics.time(LoadStatistics::Serialize);
+		QVERIFY(first >= 1000000);
+		{
+			ScopedTimer timer(&statistics, LoadStatistics::Serialize);
+			QTest::qSleep(2);
+		}
+		QVERIFY(statistics.time(LoadStatistics::Serialize) > first);
+		QCOMPARE(statistics.totalTime(), statistics.time(LoadStatistics::Serialize));
+		QVERIFY(!statistics.isEmpty());
+	}
+
+	void parserCounts() {
+		MemBuf buf(QByteArray("a=1\nb={ 1 2 }\n"));
+		Parser parser(buf, FileType::NoFile);
+		LoadStatistics statistics;
+		parser.setStatistics(&statistics);
+		QVERIFY(parser.parse() != nullptr);
+		QCOMPARE(statistics.value(LoadStatistics::Tokens), qint64(9));
+		QCOMPARE(statistics.value(LoadStatistics::Nodes), qint64(5));  // the root, a, b and b's two members
+		QCOMPARE(statistics.value(LoadStatistics::ArenaBlocks), qint64(1));
+		QVERIFY(statistics.time(LoadStatistics::Lex) > 0);
+	}
+
+	void parserCountsBlocks() {
+		QByteArray input;
+		for (int i = 0; i < 1500; i++) input += "x=1\n";
+		MemBuf buf(input);
+		Parser parser(buf, FileType::NoFile);
+		LoadStatistics statistics;
+		parser.setStatistics(&statistics);
+		QVERIFY(parser.parse() != nullptr);
+		QCOMPARE(statistics.value(LoadStatistics::Tokens), qint64(4500));
+		QCOMPARE(statistics.value(LoadStatistics::Nodes), qint64(1501));
+		QCOMPARE(statistics.value(LoadStatistics::ArenaBlocks), qint64(2));
+	}
+
+	void lazyParserCounts() {
+		MemBuf buf(QByteArray("a=1\nb={ 1 2 }\n"));
+		Parser parser(buf, FileType::NoFile);
+		LoadStatistics statistics;
+		parser.setStatistics(&statistics);
+		parser.setLazy(true);
+		AstNode *tree = parser.parse();
+		QVERIFY(tree != nullptr);
+		const qint64 lexTime = statistics.time(LoadStatistics::Lex), parseTime = statistics.time(LoadStatistics::Parse);
+		const qint64 tokens = statistics.value(LoadStatistics::Tokens), nodes = statistics.value(LoadStatistics::Nodes);
+
+		// Expanding b is timed and counted as lexing and parsing as well.
+		QCOMPARE(tree->findChildWithName("b")->countChildren(), int64_t(2));
+		QVERIFY(statistics.time(LoadStatistics::Lex) > lexTime);
+		QVERIFY(statistics.time(LoadStatistics::Parse) > parseTime);
+		QCOMPARE(statistics.value(LoadStatistics::Tokens), tokens + 6);
+		QCOMPARE(statistics.value(LoadStatistics::Nodes), nodes + 4);  // another root, b and b's two members
+	}
+
+	void json() {
+		LoadStatistics statistics;
+		statistics.addTime(LoadStatistics::Inflate, 2500000);
+		statistics.add(LoadStatistics::FileBytes, 42);
+		const QJsonObject json(statistics.toJson());
+		QCOMPARE(json.value("total_ms").toDouble(), 2.5);
+		const QJsonObject times(json.value("times_ms").toObject());
+		QCOMPARE(times.size(), qsizetype(1));  // phases that never ran are left out
+		QCOMPARE(times.value("inflate").toDouble(), 2.5);
+		QCOMPARE(json.value("counters").toObject().value("file_bytes").toInteger(), qint64(42));
+	}
+};
+
+QTEST_GUILESS_MAIN(TestInstrumentation);
+
+#include "test_instrumentation.moc"
@@ -0,0 +1,125 @@
+/* tests/test_keyword_table.cpp: Unit testing for src/core/keyword_table.h
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+
+#include <QtTest/QtTest>
+
+#include "../src/core/keyword_table.h"
+
+using Parsing::KeywordTable;
+
+// The ship sizes are the largest keyword table in the program, so they make for a realistic sample.
+static const char *const sizeNames[] = {
+		"starbase_outpost", "starbase_starport", "starbase_citadel", "starbase_starhold", "starbase_starfortress",
+		"military_station_small", "military_station_medium", "military_station_large", "ion_cannon",
+		"military_station_small_fallen_empire", "military_station_large_fallen_empire",
+		"military_station_massive_fallen_empire", "mining_station", "research_station", "observation_station",
+		"corvette", "destroyer", "cruiser", "battleship", "titan", "colossus", "transport",
+		"small_ship_fallen_empire", "large_ship_fallen_empire", "massive_ship_fallen_empire",
+		"constructor", "science", "colonizer", "sponsored_colonizer"
+};
+static constexpr int sizeCount = sizeof(sizeNames) / sizeof(sizeNames[0]);
+
+static constexpr KeywordTable<int, 29> sizeTable({{
+		{ "starbase_outpost", 0 }, { "starbase_starport", 1 }, { "starbase_citadel", 2 }, { "starbase_starhold", 3 },
+		{ "starbase_starfortress", 4 }, { "military_station_small", 5 }, { "military_station_medium", 6 },
+		{ "military_station_large", 7 }, { "ion_cannon", 8 }, { "military_station_small_fallen_empire", 9 },
+		{ "military_station_large_fallen_empire", 10 }, { "military_station_massive_fallen_empire", 11 },
+		{ "mining_station", 12 }, { "research_station", 13 }, { "observation_station", 14 }, { "corvette", 15 },
+		{ "destroyer", 16 }, { "cruiser", 17 }, { "battleship", 18 }, { "titan", 19 }, { "colossus", 20 },
+		{ "transport", 21 }, { "small_ship_fallen_empire", 22 }, { "large_ship_fallen_empire", 23 },
+		{ "massive_ship_fallen_empire", 24 }, { "constructor", 25 }, { "science", 26 }, { "colonizer", 27 },
+		{ "sponsored_colonizer", 28 }
+}});
+
+// Lookups can already be answered by the compiler.
+static_assert(sizeTable.value("titan", -1) == 19, "constexpr lookup");
+static_assert(!sizeTable.contains("titans"), "constexpr miss");
+
+class TestKeywordTable : public QObject {
+	Q_OBJECT
+private slots:
+	void findsAllKeys() {
+		for (int i = 0; i < sizeCount; i++) {
+			auto found = sizeTable.find(sizeNames[i]);
+			QVERIFY2(found.has_value(), sizeNames[i]);
+			QCOMPARE(*found, i);
+		}
+	}
+
+	void rejectsOtherKeys_data() {
+		QTest::addColumn<QByteArray>("key");
+
+		QTest::newRow("empty") << QByteArray("");
+		QTest::newRow("prefix") << QByteArray("corvett");
+		QTest::newRow("suffix") << QByteArray("corvettes");
+		QTest::newRow("case") << QByteArray("Corvette");
+		QTest::newRow("embedded nul") << QByteArray("corvette\0", 9);
+		QTest::newRow("unrelated") << QByteArray("juggernaut");
+	}
+	void rejectsOtherKeys() {
+		QFETCH(QByteArray, key);
+		QVERIFY(!sizeTable.contains(std::string_view(key.constData(), key.size())));
+		QCOMPARE(sizeTable.value(std::string_view(key.constData(), key.size()), -1), -1);
+	}
+
+	void singleEntry() {
+		static constexpr KeywordTable<bool, 1> table({{ { "yes", true } }});
+		QVERIFY(table.value("yes", false));
+		QVERIFY(!table.contains("no"));
+	}
+
+	// The following compare the cost of one lookup per ship size name with the approaches
+	// that the keyword tables replaced.
+	void benchKeywordTable() {
+		int sum = 0;
+		QBENCHMARK {
+			for (const char *name : sizeNames) sum += sizeTable.value(name, 0);
+		}
+		QVERIFY(sum > 0);
+	}
+
+	void benchQMap() {
+		QMap<QString, int> map;
+		for (int i = 0; i < sizeCount; i++) map.insert(sizeNames[i], i);
+		int sum = 0;
+		QBENCHMARK {
+			for (const char *name : sizeNames) sum += map.value(name, 0);
+		}
+		QVERIFY(sum > 0);
+	}
+
+	void benchStrcmpChain() {
+		int sum = 0;
+		QBENCHMARK {
+			for (const char *name : sizeNames) {
+				for (int i = 0; i < sizeCount; i++) {
+					if (strcmp(name, sizeNames[i]) == 0) {
+						sum += i;
+						break;
+					}
+				}
+			}
+		}
+		QVERIFY(sum > 0);
+	}
+};
+
+QTEST_GUILESS_MAIN(TestKeywordTable);
+
+#include "test_keyword_table.moc"
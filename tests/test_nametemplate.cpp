@@ -0,0 +1,67 @@
+/* tests/test_nametemplate.cpp: Unit testing for src/core/nametemplate.h
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <QtTest/QtTest>
+
+#include "../src/core/nametemplate.h"
+
+typedef QHash<QByteArray, QByteArray> Variables;
+Q_DECLARE_METATYPE(Variables)
+
+class TestNameTemplate : public QObject {
+	Q_OBJECT
+private slots:
+	void apply_data() {
+		QTest::addColumn<QString>("format");
+		QTest::addColumn<Variables>("variables");
+		QTest::addColumn<QString>("expected");
+
+		QTest::newRow("angles and squares") << "<prefix> [adjective] Republic"
+				<< Variables({ { "prefix", "United" }, { "adjective", "Terran" } }) << "United Terran Republic";
+		QTest::newRow("repeated square") << "[name] of [name]"
+				<< Variables({ { "name", "Sol" } }) << "Sol of Sol";
+		QTest::newRow("only the first square") << "[first] and [second]"
+				<< Variables({ { "first", "One" }, { "second", "Two" } }) << "One and [second]";
+		QTest::newRow("unknown variable") << "<missing> Empire" << Variables() << " Empire";
+		QTest::newRow("no placeholders") << "Commonwealth of Man" << Variables() << "Commonwealth of Man";
+		QTest::newRow("angle in a value") << "<outer> Empire"
+				<< Variables({ { "outer", "<inner> Star" }, { "inner", "Blue" } }) << "Blue Star Empire";
+		QTest::newRow("square in a value") << "<prefix> Union"
+				<< Variables({ { "prefix", "[adjective]" }, { "adjective", "Red" } }) << "Red Union";
+		QTest::newRow("square across a placeholder") << "[<a>] Pact"
+				<< Variables({ { "a", "x" }, { "x", "Iron" } }) << "Iron Pact";
+		QTest::newRow("value refers to itself") << "<a>"
+				<< Variables({ { "a", "<a>x" } }) << "<a>" + QString(32, QLatin1Char('x'));
+	}
+
+	void apply() {
+		QFETCH(QString, format);
+		QFETCH(Variables, variables);
+		QFETCH(QString, expected);
+
+		NameTemplate nameTemplate(format);
+		NameTemplate::Variables values;
+		for (auto it = variables.cbegin(); it != variables.cend(); it++) {
+			values.append({ it.key().constData(), QString::fromUtf8(it.value()) });
+		}
+		QCOMPARE(nameTemplate.apply(values), expected);
+	}
+};
+
+QTEST_GUILESS_MAIN(TestNameTemplate);
+
+#include "test_nametemplate.moc"
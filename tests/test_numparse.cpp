@@ -0,0 +1,216 @@
+/* tests/test_numparse.cpp: Unit testing for src/core/numparse.h
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include <QtTest/QtTest>
+
+#include "../src/core/numparse.h"
+
+using Parsing::parseInt;
+using Parsing::parseDouble;
+
+// The same bits, so that -0.0 and 0.0 are told apart.
+static bool sameDouble(double a, double b) {
+	return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// A number the way the game writes it: an optional minus sign, and a fixed number of decimals.
+static QByteArray gameNumber(QRandomGenerator &random) {
+	QByteArray number;
+	if (random.bounded(2)) number += '-';
+	number += QByteArray::number(random.generate64() % (random.bounded(2) ? 1000 : 10000000000ull));
+	const int decimals = random.bounded(6);
+	if (decimals > 0) {
+		number += '.';
+		for (int i = 0; i < decimals; i++) number += char('0' + random.bounded(10));
+	}
+	return number;
+}
+
+class TestNumParse : public QObject {
+	Q_OBJECT
+private:
+	QVector<QByteArray> doubleSample;
+	QVector<QByteArray> intSample;
+
+private slots:
+	void initTestCase() {
+		// strtod() is the reference; make sure it expects the same format.
+		setlocale(LC_NUMERIC, "C");
+		QRandomGenerator random(2019);
+		for (int i = 0; i < 10000; i++) {
+			doubleSample.append(gameNumber(random));
+			intSample.append(QByteArray::number(qint64(random.generate64())));
+		}
+	}
+
+	void ints_data() {
+		QTest::addColumn<QByteArray>("input");
+		QTest::addColumn<int>("consumed");
+		QTest::addColumn<qint64>("value");
+
+		QTest::newRow("zero") << QByteArray("0") << 1 << qint64(0);
+		QTest::newRow("negative") << QByteArray("-42") << 3 << qint64(-42);
+		QTest::newRow("leading zeros") << QByteArray("007") << 3 << qint64(7);
+		QTest::newRow("trailing junk") << QByteArray("12abc") << 2 << qint64(12);
+		QTest::newRow("max") << QByteArray("9223372036854775807") << 19 << qint64(INT64_MAX);
+		QTest::newRow("min") << QByteArray("-9223372036854775808") << 20 << qint64(INT64_MIN);
+		QTest::newRow("too large") << QByteArray("9223372036854775808") << 19 << qint64(INT64_MAX);
+		QTest::newRow("way too large") << QByteArray("99999999999999999999999") << 23 << qint64(INT64_MAX);
+		QTest::newRow("too small") << QByteArray("-99999999999999999999") << 21 << qint64(INT64_MIN);
+		QTest::newRow("sign only") << QByteArray("-") << 0 << qint64(0);
+		QTest::newRow("empty") << QByteArray("") << 0 << qint64(0);
+	}
+	void ints() {
+		QFETCH(QByteArray, input);
+		QFETCH(int, consumed);
+		QFETCH(qint64, value);
+		int64_t result = 0;
+		const char *end = parseInt(input.constData(), input.constData() + input.size(), &result);
+		QCOMPARE(int(end - input.constData()), consumed);
+		QCOMPARE(qint64(result), value);
+	}
+
+	void doubles_data() {
+		QTest::addColumn<QByteArray>("input");
+		QTest::addColumn<int>("consumed");
+
+		QTest::newRow("integer") << QByteArray("12") << 2;
+		QTest::newRow("fixed decimals") << QByteArray("1.500") << 5;
+		QTest::newRow("negative") << QByteArray("-0.25") << 5;
+		QTest::newRow("negative zero") << QByteArray("-0.000") << 6;
+		QTest::newRow("no integer part") << QByteArray("-.5") << 3;
+		QTest::newRow("no fraction") << QByteArray("3.") << 2;
+		QTest::newRow("date") << QByteArray("2300.01.01") << 7;
+		QTest::newRow("exponent") << QByteArray("1.5e3") << 5;
+		QTest::newRow("negative exponent") << QByteArray("25E-2") << 5;
+		QTest::newRow("incomplete exponent") << QByteArray("2e") << 1;
+		QTest::newRow("many digits") << QByteArray("123456789012345678901234.5") << 26;
+		QTest::newRow("tiny") << QByteArray("0.000000000000000000000000000001") << 32;
+		QTest::newRow("small and exact") << QByteArray("0.1") << 3;
+	}
+	void doubles() {
+		QFETCH(QByteArray, input);
+		QFETCH(int, consumed);
+		double result = 0;
+		const char *end = parseDouble(input.constData(), input.constData() + input.size(), &result);
+		QCOMPARE(int(end - input.constData()), consumed);
+		QVERIFY2(sameDouble(result, strtod(input.constData(), nullptr)), input.constData());
+	}
+
+	void no_digits_data() {
+		QTest::addColumn<QByteArray>("input");
+		QTest::newRow("empty") << QByteArray("");
+		QTest::newRow("sign only") << QByteArray("-");
+		QTest::newRow("point only") << QByteArray(".");
+		QTest::newRow("sign and point") << QByteArray("-.");
+		QTest::newRow("letters") << QByteArray("e5");
+	}
+	void no_digits() {
+		QFETCH(QByteArray, input);
+		double result = 42;
+		QCOMPARE(parseDouble(input.constData(), input.constData() + input.size(), &result), input.constData());
+		QCOMPARE(result, 42.0);
+	}
+
+	// Everything the game writes must come out exactly as strtod() reads it.
+	void roundtrip_game_numbers() {
+		QRandomGenerator random(46);
+		for (int i = 0; i < 2000000; i++) {
+			const QByteArray number = gameNumber(random);
+			double result;
+			parseDouble(number.constData(), number.constData() + number.size(), &result);
+			if (!sameDouble(result, strtod(number.constData(), nullptr))) QFAIL(number.constData());
+		}
+	}
+
+	// As well as anything else a double can be written as.
+	void roundtrip_any_double() {
+		QRandomGenerator random(47);
+		char number[64];
+		for (int i = 0; i < 1000000; i++) {
+			quint64 bits = random.generate64();
+			double value;
+			memcpy(&value, &bits, sizeof(double));
+			// Rounding the largest ones to fewer digits might push them past the largest double.
+			if (!qIsFinite(value) || qAbs(value) > 1e300) continue;
+			snprintf(number, sizeof(number), "%.*g", random.bounded(1, 18), value);
+			double result;
+			parseDouble(number, number + strlen(number), &result);
+			if (!sameDouble(result, strtod(number, nullptr))) QFAIL(number);
+		}
+	}
+
+	void roundtrip_ints() {
+		QRandomGenerator random(48);
+		for (int i = 0; i < 1000000; i++) {
+			const QByteArray number = QByteArray::number(qint64(random.generate64()) >> random.bounded(64));
+			int64_t result;
+			parseInt(number.constData(), number.constData() + number.size(), &result);
+			if (result != strtoll(number.constData(), nullptr, 10)) QFAIL(number.constData());
+		}
+	}
+
+	// The following compare the throughput of the lexer's number parsing with that of the C library.
+	void benchParseDouble() {
+		double sum = 0;
+		QBENCHMARK {
+			for (const QByteArray &number : std::as_const(doubleSample)) {
+				double value;
+				parseDouble(number.constData(), number.constData() + number.size(), &value);
+				sum += value;
+			}
+		}
+		QVERIFY(sum != 0);
+	}
+
+	void benchStrtod() {
+		double sum = 0;
+		QBENCHMARK {
+			for (const QByteArray &number : std::as_const(doubleSample)) sum += strtod(number.constData(), nullptr);
+		}
+		QVERIFY(sum != 0);
+	}
+
+	void benchParseInt() {
+		uint64_t sum = 0;  // unsigned, so that adding the random sample may wrap around
+		QBENCHMARK {
+			for (const QByteArray &number : std::as_const(intSample)) {
+				int64_t value;
+				parseInt(number.constData(), number.constData() + number.size(), &value);
+				sum += value;
+			}
+		}
+		QVERIFY(sum != 0);
+	}
+
+	void benchStrtoll() {
+		uint64_t sum = 0;
+		QBENCHMARK {
+			for (const QByteArray &number : std::as_const(intSample)) sum += strtoll(number.constData(), nullptr, 10);
+		}
+		QVERIFY(sum != 0);
+	}
+};
+
+QTEST_GUILESS_MAIN(TestNumParse);
+
+#include "test_numparse.moc"
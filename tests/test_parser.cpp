@@ -654,6 +654,8 @@ private slots:
 		QTest::newRow("unexpected end of input") << "stuff = {" << Parsing::PE_UNEXPECTED_END;
 		QTest::newRow("too many closing braces") << "stuff = { } }" << Parsing::PE_TOO_MANY_CLOSE_BRACES;
 		QTest::newRow("3.0 hack doesn't apply") << "not_intel = { { 56 { intel = 50 stale_intel = { } } } }" << Parsing::PE_INVALID_AFTER_NAME;
+		QTest::newRow("3.0 hack at top level") << "stuff { }" << Parsing::PE_INVALID_AFTER_NAME;
+		QTest::newRow("3.0 hack in a compound") << "stuff = { a = 1 b { } }" << Parsing::PE_INVALID_AFTER_NAME;
 	}
 	void invalid() {
 		using namespace Parsing;
@@ -688,6 +690,287 @@ private slots:
 		QCOMPARE(tree->val.firstChild->val.firstChild->type, NT_COMPOUNDLIST_MEMBER);
 		QCOMPARE(tree->val.firstChild->val.firstChild->val.firstChild->type, NT_COMPOUND);
 	}
+
+	void hack_for_3_0_resilient() {
+		using namespace Parsing;
+
+		MemBuf buf(QByteArray("name { }\nstuff = { a = 1 b { } c = 2 }\nd = 3\n"));
+		Parser parser(buf, FileType::NoFile);
+		parser.setResilient(true);
+		AstNode *tree = parser.parse();
+		QVERIFY(tree != nullptr);
+
+		const std::vector<ParserError> &errors = parser.getErrors();
+		QCOMPARE(errors.size(), size_t(2));
+		QCOMPARE(errors[0].etype, PE_INVALID_AFTER_NAME);
+		QCOMPARE(errors[0].erroredToken.line, uint64_t(1));
+		QCOMPARE(errors[1].etype, PE_INVALID_AFTER_NAME);
+		QCOMPARE(errors[1].erroredToken.line, uint64_t(2));
+
+		QCOMPARE(tree->findChildWithName("name")->type, NT_EMPTY);
+		AstNode *stuff = tree->findChildWithName("stuff");
+		QCOMPARE(stuff->type, NT_COMPOUND);
+		QCOMPARE(stuff->findChildWithName("a")->val.Int, int64_t(1));
+		QCOMPARE(stuff->findChildWithName("b")->type, NT_EMPTY);
+		QCOMPARE(stuff->findChildWithName("c")->val.Int, int64_t(2));
+		QCOMPARE(tree->findChildWithName("d")->val.Int, int64_t(3));
+	}
+
+	void long_strings() {
+		QByteArray name(200, 'n');
+		QByteArray value;
+		for (int i = 0; i < 1000; i++) value += char('a' + i % 26);
+		MemBuf buf(name + "=\"" + value + "\"\nlist={ \"" + value + "\" " + name + " }\n" + name + "={ }\n");
+		Parser parser(buf, FileType::NoFile);
+		AstNode *tree = parser.parse();
+		QVERIFY(tree != nullptr);
+
+		AstNode *string = tree->val.firstChild;
+		QCOMPARE(QByteArray(string->myName), name);
+		QCOMPARE(string->type, NT_STRING);
+		QCOMPARE(QByteArray(string->val.Str), value);
+
+		AstNode *list = tree->findChildWithName("list");
+		QCOMPARE(list->type, NT_STRINGLIST);
+		QCOMPARE(QByteArray(list->val.firstChild->val.Str), value);
+		QCOMPARE(QByteArray(list->val.lastChild->val.Str), name);
+
+		// Equal strings are stored only once.
+		AstNode *empty = tree->val.lastChild;
+		QVERIFY(empty->myName == string->myName);
+		QVERIFY(list->val.firstChild->val.Str == string->val.Str);
+		QVERIFY(list->val.lastChild->val.Str == string->myName);
+	}
+
+	void int_keys() {
+		using namespace Parsing;
+
+		MemBuf buf(QByteArray("country={ 0={ a=1 } 4294967296={ a=2 } -1={ a=3 } name={ a=4 } }\n"
+				"ships={ { 12=yes } }\n"));
+		Parser parser(buf, FileType::NoFile);
+		AstNode *tree = parser.parse();
+		QVERIFY(tree != nullptr);
+		AstNode *country = tree->findChildWithName("country");
+		QVERIFY(!country->keyIsInt);
+		const int64_t keys[] = { 0, 4294967296, -1 };
+		AstNode *child = country->val.firstChild;
+		for (int64_t key : keys) {
+			QVERIFY(child->keyIsInt);
+			QCOMPARE(child->intKey, key);
+			QCOMPARE(QByteArray(child->myName), QByteArray::number(qint64(key)));
+			child = child->nextSibling;
+		}
+		QVERIFY(!child->keyIsInt);
+		QCOMPARE(qstrcmp(child->myName, "name"), 0);
+
+		// Keys within the members of a compound list
+		AstNode *ship = tree->findChildWithName("ships")->val.firstChild->val.firstChild;
+		QVERIFY(ship->keyIsInt);
+		QCOMPARE(ship->intKey, int64_t(12));
+		QCOMPARE(qstrcmp(ship->myName, "12"), 0);
+	}
+
+	void section_filter() {
+		using namespace Parsing;
+
+		MemBuf buf(QByteArray("date=\"2300.01.01\"\nspecies={ 0={ name=\"Humans\" } }\nbig>=3\n"
+				"country={ 0={ name=\"Earth\" } }\nplanets={ { a=1 } { b={ } } }\nfleet={ }\n"));
+		Parser parser(buf, FileType::NoFile);
+		parser.setSectionFilter({ "date", "country", "fleet" });
+		AstNode *tree = parser.parse();
+		QVERIFY(tree != nullptr);
+		QCOMPARE(tree->countChildren(), int64_t(3));
+		QVERIFY(tree->findChildWithName("species") == nullptr);
+		QVERIFY(tree->findChildWithName("big") == nullptr);
+		QVERIFY(tree->findChildWithName("planets") == nullptr);
+		AstNode *country = tree->findChildWithName("country");
+		QVERIFY(country != nullptr);
+		QCOMPARE(qstrcmp(country->val.firstChild->findChildWithName("name")->val.Str, "Earth"), 0);
+
+		QVERIFY(parser.releaseSection(country));
+		QVERIFY(!parser.releaseSection(country));
+		QCOMPARE(tree->countChildren(), int64_t(2));
+		QVERIFY(tree->findChildWithName("country") == nullptr);
+		QCOMPARE(qstrcmp(tree->findChildWithName("date")->val.Str, "2300.01.01"), 0);
+		QVERIFY(tree->findChildWithName("fleet") != nullptr);
+	}
+
+	void memory_budget() {
+		using namespace Parsing;
+
+		QByteArray input("list={");
+		for (int i = 0; i < 20000; i++) input += " { a=1 }";
+		input += " }\n";
+		{
+			MemBuf buf(input);
+			Parser parser(buf, FileType::NoFile);
+			parser.setMemoryBudget(1 << 20);
+			QCOMPARE(parser.parse(), nullptr);
+			QCOMPARE(parser.getLatestParserError().etype, PE_MEMORY_BUDGET_EXCEEDED);
+		}
+		{
+			MemBuf buf(input);
+			Parser parser(buf, FileType::NoFile);
+			parser.setMemoryBudget(64 << 20);
+			QVERIFY(parser.parse() != nullptr);
+			QVERIFY(parser.memoryInUse() > input.size());
+		}
+	}
+
+	void lazy() {
+		using namespace Parsing;
+
+		MemBuf buf(QByteArray("date=\"2300.01.01\"\nspecies={ 0={ name=\"Humans}\" } }  # not a brace: }\n"
+				"country={\n0={ name=\"Earth\" quote=\"\\\"{\" }\n}\nlist={ 1 2 3 }\n"));
+		Parser parser(buf, FileType::NoFile);
+		parser.setLazy(true);
+		AstNode *tree = parser.parse();
+		QVERIFY(tree != nullptr);
+		QCOMPARE(tree->countChildren(), int64_t(4));
+		QCOMPARE(tree->val.firstChild->type, NT_STRING);
+		for (AstNode *child = tree->val.firstChild->nextSibling; child; child = child->nextSibling) {
+			QCOMPARE(child->type, NT_LAZY);
+		}
+
+		AstNode *country = tree->findChildWithName("country");
+		QCOMPARE(country->type, NT_COMPOUND);
+		AstNode *earth = country->findChildWithName("0");
+		QCOMPARE(qstrcmp(earth->findChildWithName("name")->val.Str, "Earth"), 0);
+		QCOMPARE(qstrcmp(earth->findChildWithName("quote")->val.Str, "\\\"{"), 0);  // the lexer keeps the backslash
+		QCOMPARE(tree->val.firstChild->nextSibling->type, NT_LAZY);  // species is left alone
+
+		AstNode *list = tree->findChildWithName("list");
+		QCOMPARE(list->type, NT_INTLIST);
+		QCOMPARE(list->countChildren(), int64_t(3));
+		QCOMPARE(list->val.lastChild->val.Int, int64_t(3));
+		QCOMPARE(qstrcmp(tree->findChildWithName("species")->val.firstChild->findChildWithName("name")->val.Str,
+				"Humans}"), 0);
+	}
+
+	void lazy_error() {
+		using namespace Parsing;
+
+		MemBuf buf(QByteArray("a={ b=1 }\nc={ d= }\n"));
+		Parser parser(buf, FileType::NoFile);
+		parser.setLazy(true);
+		AstNode *tree = parser.parse();
+		QVERIFY(tree != nullptr);
+		QCOMPARE(tree->findChildWithName("a")->findChildWithName("b")->val.Int, int64_t(1));
+		AstNode *c = tree->findChildWithName("c");
+		QCOMPARE(c->type, NT_EMPTY);
+		QCOMPARE(parser.getLatestParserError().etype, PE_INVALID_AFTER_EQUALS);
+		QCOMPARE(parser.getLatestParserError().erroredToken.line, uint64_t(2));
+
+		MemBuf unterminated(QByteArray("a={ b={ }\n"));
+		Parser unterminatedParser(unterminated, FileType::NoFile);
+		unterminatedParser.setLazy(true);
+		QCOMPARE(unterminatedParser.parse(), nullptr);
+		QCOMPARE(unterminatedParser.getLatestParserError().etype, PE_UNEXPECTED_END);
+	}
+
+	void lazy_lookahead() {
+		using namespace Parsing;
+
+		// Only expanding `a' reads the invalid number, however far ahead of `a' the lexer would otherwise go.
+		const QByteArray input("a={ b=- }\nc=1\n");
+		{
+			MemBuf buf(input);
+			Parser parser(buf, FileType::NoFile);
+			parser.setLazy(true);
+			AstNode *tree = parser.parse();
+			QVERIFY(tree != nullptr);
+			QCOMPARE(tree->findChildWithName("c")->val.Int, int64_t(1));
+		}
+		{
+			MemBuf buf(input);
+			Parser parser(buf, FileType::NoFile);
+			parser.setLazy(true);
+			parser.setResilient(true);
+			AstNode *tree = parser.parse();
+			QVERIFY(tree != nullptr);
+			QCOMPARE(parser.getErrors().size(), size_t(0));
+			QCOMPARE(qstrcmp(tree->findChildWithName("a")->findChildWithName("b")->val.Str, "-"), 0);
+			QCOMPARE(parser.getErrors().size(), size_t(1));
+			QCOMPARE(parser.getErrors().front().etype, LE_INVALID_INT);
+		}
+	}
+
+	void lazy_memory_budget() {
+		using namespace Parsing;
+
+		QByteArray input("small={ a=1 }\nlist={");
+		for (int i = 0; i < 20000; i++) input += " { a=1 }";
+		input += " }\nlater={ b=2 }\n";
+		{
+			MemBuf buf(input);
+			Parser parser(buf, FileType::NoFile);
+			parser.setLazy(true);
+			parser.setMemoryBudget(1 << 20);
+			AstNode *tree = parser.parse();
+			QVERIFY(tree != nullptr);  // only the top level, which fits
+			QCOMPARE(tree->findChildWithName("small")->findChildWithName("a")->val.Int, int64_t(1));
+			QCOMPARE(tree->findChildWithName("list")->type, NT_EMPTY);
+			QCOMPARE(parser.getLatestParserError().etype, PE_MEMORY_BUDGET_EXCEEDED);
+			QCOMPARE(tree->findChildWithName("later")->type, NT_EMPTY);  // nothing more is expanded
+		}
+		{
+			MemBuf buf(input);
+			Parser parser(buf, FileType::NoFile);
+			parser.setLazy(true);
+			parser.setMemoryBudget(64 << 20);
+			AstNode *tree = parser.parse();
+			QVERIFY(tree != nullptr);
+			QCOMPARE(tree->findChildWithName("list")->countChildren(), int64_t(20000));
+			QCOMPARE(tree->findChildWithName("later")->findChildWithName("b")->val.Int, int64_t(2));
+			QCOMPARE(parser.getLatestParserError().etype, PE_NONE);
+		}
+	}
+
+	void resilient() {
+		MemBuf buf(QByteArray("a=1\nb={ c= }\nd={ 1 2 x { y } }\n}\ne=-\nf={ x = { = } y=1 }\ng={ h={ 1 2 } i={\n"));
+		Parser parser(buf, FileType::NoFile);
+		parser.setResilient(true);
+		AstNode *tree = parser.parse();
+		QVERIFY(tree != nullptr);
+
+		const std::vector<ParserError> &errors = parser.getErrors();
+		QCOMPARE(errors.size(), size_t(6));
+		// The lexer reads ahead, so the input is short enough for its error to be found first.
+		QCOMPARE(errors[0].etype, LE_INVALID_INT);
+		QCOMPARE(errors[0].erroredToken.line, uint64_t(5));
+		QCOMPARE(errors[1].etype, PE_INVALID_AFTER_EQUALS);
+		QCOMPARE(errors[1].erroredToken.line, uint64_t(2));
+		QCOMPARE(errors[2].etype, PE_INVALID_IN_INT_LIST);
+		QCOMPARE(errors[3].etype, PE_TOO_MANY_CLOSE_BRACES);
+		QCOMPARE(errors[4].etype, PE_INVALID_AFTER_OPEN);
+		QCOMPARE(errors[5].etype, PE_UNEXPECTED_END);
+
+		QCOMPARE(tree->findChildWithName("a")->val.Int, int64_t(1));
+		// A value that is missing empties its node only.
+		AstNode *b = tree->findChildWithName("b");
+		QCOMPARE(b->type, NT_COMPOUND);
+		QCOMPARE(b->findChildWithName("c")->type, NT_EMPTY);
+		// A bad list member empties the list.
+		QCOMPARE(tree->findChildWithName("d")->type, NT_EMPTY);
+		// A number that isn't one is kept as a string.
+		QCOMPARE(tree->findChildWithName("e")->type, NT_STRING);
+		QCOMPARE(qstrcmp(tree->findChildWithName("e")->val.Str, "-"), 0);
+		AstNode *f = tree->findChildWithName("f");
+		QCOMPARE(f->findChildWithName("x")->type, NT_EMPTY);
+		QCOMPARE(f->findChildWithName("y")->val.Int, int64_t(1));
+		// What has been read of an unfinished node is kept.
+		AstNode *g = tree->findChildWithName("g");
+		QCOMPARE(g->type, NT_COMPOUND);
+		QCOMPARE(g->findChildWithName("h")->countChildren(), int64_t(2));
+		QCOMPARE(g->findChildWithName("i")->type, NT_EMPTY);
+
+		// None of this is acceptable otherwise.
+		MemBuf strictBuf(QByteArray("a=1\nb={ c= }\n"));
+		Parser strictParser(strictBuf, FileType::NoFile);
+		QCOMPARE(strictParser.parse(), nullptr);
+		QCOMPARE(strictParser.getLatestParserError().etype, PE_INVALID_AFTER_EQUALS);
+		QVERIFY(strictParser.getErrors().empty());
+	}
 };
 
 QTEST_GUILESS_MAIN(TestParser);
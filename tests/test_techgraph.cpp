@@ -0,0 +1,127 @@
+/* tests/test_techgraph.cpp: Unit testing for src/core/techgraph.h and src/core/dynamic_bitset.h
+ *
+ * Copyright 2019 Adrian "ArdiMaster" Welcker
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include <QtTest/QtTest>
+
+#include "../src/core/dynamic_bitset.h"
+#include "../src/core/galaxy_model.h"
+#include "../src/core/parser.h"
+#include "../src/core/techgraph.h"
+#include "../src/core/technology.h"
+
+using Galaxy::DynamicBitset;
+using Galaxy::TechGraph;
+
+// Ids are assigned in name order, so tech_a is 0, tech_b is 1 and so on.
+static const char techFile[] =
+		"tech_a = { area = physics tier = 0 start_tech = yes }\n"
+		"tech_b = { area = physics tier = 1 prerequisites = { \"tech_a\" } }\n"
+		"tech_c = { area = society tier = 1 prerequisites = { \"tech_a\" } }\n"
+		"tech_d = { area = physics tier = 2 prerequisites = { \"tech_b\" \"tech_c\" } }\n"
+		"tech_e = { area = engineering tier = 3 prerequisites = { \"tech_d\" \"tech_unknown\" } }\n"
+		"tech_f = { area = engineering tier = 0 }\n";
+
+static QList<int> elements(const DynamicBitset &set) {
+	QList<int> result;
+	for (int i = set.next(0); i >= 0; i = set.next(i + 1)) result.append(i);
+	return result;
+}
+
+static QList<int> elements(TechGraph::Ids ids) {
+	QList<int> result;
+	for (int id : ids) result.append(id);
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+class TestTechGraph : public QObject {
+	Q_OBJECT
+private slots:
+	void initTestCase() {
+		Parsing::MemBuf buf(QByteArray(techFile));
+		Parsing::Parser parser(buf, Parsing::FileType::GameFile);
+		model.addTechnologies(parser.parse());
+		QCOMPARE(model.getTechnologies().size(), 6);
+		graph = TechGraph(model);
+	}
+
+	void bitsetAcrossWords() {
+		DynamicBitset set(130), other(130);
+		set.set(0);
+		set.set(63);
+		set.set(64);
+		set.set(129);
+		QCOMPARE(elements(set), QList<int>({ 0, 63, 64, 129 }));
+		QCOMPARE(set.count(), 4);
+		set.reset(63);
+		QVERIFY(!set.test(63));
+
+		other.set(64);
+		other.set(100);
+		QCOMPARE(set.countCommon(other), 1);
+		QVERIFY(set.intersects(other));
+		QVERIFY(!other.isSubsetOf(set));
+		QCOMPARE(elements(set - other), QList<int>({ 0, 129 }));
+		QCOMPARE(elements(set | other), QList<int>({ 0, 64, 100, 129 }));
+		QVERIFY((set & other).isSubsetOf(set));
+		QVERIFY(!DynamicBitset(130).any());
+	}
+
+	void ids() {
+		QCOMPARE(graph.size(), 6);
+		QCOMPARE(graph.idOf("tech_a"), 0);
+		QCOMPARE(graph.idOf("tech_f"), 5);
+		QCOMPARE(graph.idOf("tech_unknown"), -1);
+		QCOMPARE(graph.technology(3)->getName(), QString("tech_d"));
+		QCOMPARE(elements(graph.setOf({ "tech_b", "tech_unknown", "tech_e" })), QList<int>({ 1, 4 }));
+	}
+
+	void adjacency() {
+		QCOMPARE(elements(graph.prerequisites(3)), QList<int>({ 1, 2 }));
+		QCOMPARE(elements(graph.prerequisites(4)), QList<int>({ 3 }));  // the unknown one is dropped
+		QCOMPARE(elements(graph.dependents(0)), QList<int>({ 1, 2 }));
+		QCOMPARE(graph.dependents(5).size(), 0);
+	}
+
+	void closures() {
+		QCOMPARE(elements(graph.ancestors(4)), QList<int>({ 0, 1, 2, 3 }));
+		QCOMPARE(elements(graph.descendants(0)), QList<int>({ 1, 2, 3, 4 }));
+		QVERIFY(!graph.ancestors(0).any());
+		QVERIFY(!graph.descendants(5).any());
+	}
+
+	void queries() {
+		const DynamicBitset researchedAB(graph.setOf({ "tech_a", "tech_b" }));
+		QCOMPARE(elements(graph.researchPath(4, researchedAB)), QList<int>({ 2, 3, 4 }));
+		QCOMPARE(elements(graph.frontier(DynamicBitset(graph.size()))), QList<int>({ 0, 5 }));
+		QCOMPARE(elements(graph.frontier(researchedAB)), QList<int>({ 2, 5 }));
+		// tech_d also needs tech_c, so tech_b on its own doesn't unlock anything...
+		QVERIFY(!graph.unlockedBy(1, graph.setOf({ "tech_a" })).any());
+		// ...but tech_c does once tech_b is there.
+		QCOMPARE(elements(graph.unlockedBy(2, researchedAB)), QList<int>({ 3 }));
+	}
+
+private:
+	Galaxy::Model model;
+	TechGraph graph;
+};
+
+QTEST_GUILESS_MAIN(TestTechGraph);
+
+#include "test_techgraph.moc"